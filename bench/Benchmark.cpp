@@ -0,0 +1,279 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include "Sudoku.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "TestFunctions.hpp"
+#include "IndividualFunction.hpp"
+
+// Every result is printed as one JSON object per line.
+class Benchmark
+{
+private:
+  double minSeconds;
+  volatile double sink;
+
+  template<class F>
+  void measure(const std::string &name, F f, size_t operations = 1);
+
+  template<size_t B>
+  void benchmarkSudoku(std::shared_ptr<const SudokuInstance> instance);
+  template<size_t B>
+  void benchmarkReplacement(std::shared_ptr<const SudokuInstance> instance);
+  void benchmarkTestFunctions();
+  void benchmarkBatch();
+  void benchmarkIndividualFunction();
+  template<size_t B>
+  void benchmarkRuns(const std::string &filename, std::shared_ptr<const SudokuInstance> instance, int runs, double maxSeconds);
+
+  static double percentile(std::vector<double> values, double p);
+
+public:
+  Benchmark(double minSeconds) : minSeconds(minSeconds), sink(0) {}
+
+  void micro(const std::string &filename);
+  void macro(const std::vector<std::string> &filenames, int runs, double maxSeconds);
+};
+
+// A call of f can count as several operations, ns_per_op is divided by them.
+template<class F>
+void Benchmark::measure(const std::string &name, F f, size_t operations)
+{
+    size_t iterations = 1;
+    double elapsed = 0;
+    f(0);
+    while (elapsed < minSeconds)
+    {
+        iterations *= 2;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            f(i);
+        }
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::cout << "{\"type\":\"micro\",\"name\":\"" << name << "\",\"iterations\":" << iterations
+              << ",\"ns_per_op\":" << elapsed * 1e9 / (iterations * operations) << "}" << std::endl;
+}
+
+template<size_t B>
+void Benchmark::benchmarkSudoku(std::shared_ptr<const SudokuInstance> instance)
+{
+    const size_t poolSize = 64;
+    BasicSudoku<B> sudoku(instance);
+    std::vector<BasicSudoku<B>> pool(poolSize, sudoku);
+    for (size_t i = 0; i < poolSize; i++)
+    {
+        pool[i].setSeed(i);
+        pool[i].initRandom();
+    }
+    BasicSudoku<B> work = sudoku;
+    measure("sudoku.getConflictsRowsAndCols", [&](size_t i) {
+        sink = sink + pool[i % poolSize].getConflictsRowsAndCols();
+    });
+    measure("sudoku.getDistance", [&](size_t i) {
+        sink = sink + pool[i % poolSize].getDistance(pool[(i + 1) % poolSize]);
+    });
+    measure("sudoku.copy+stochasticLocalSearch(20)", [&](size_t i) {
+        work = pool[i % poolSize];
+        sink = sink + work.stochasticLocalSearch(20);
+    });
+    measure("sudoku.copy", [&](size_t i) {
+        work = pool[i % poolSize];
+        sink = sink + work.getFitness();
+    });
+    measure("sudoku.mutate", [&](size_t i) {
+        pool[i % poolSize].mutate(1);
+    });
+    measure("sudoku.cross", [&](size_t i) {
+        pool[i % poolSize].cross(pool[(i + 1) % poolSize], i % sudoku.getGenotypeLength());
+    });
+}
+
+template<size_t B>
+void Benchmark::benchmarkReplacement(std::shared_ptr<const SudokuInstance> instance)
+{
+    BasicSudoku<B> sudoku(instance);
+    GeneticAlgorithm<BasicSudoku<B>> ga(sudoku, 50, 1, 80, 0);
+    ga.setSeed(1);
+    ga.initPoblation();
+    ga.improvePopulation();
+    ga.createOffspring();
+    measure("ga.multiDynamic(P=50)", [&](size_t) {
+        ga.replacement(5);
+    });
+    measure("ga.nextGeneration(P=50)", [&](size_t) {
+        ga.nextGeneration(5);
+    });
+}
+
+void Benchmark::benchmarkTestFunctions()
+{
+    const size_t dimensions = 1000;
+    std::vector<double> x(dimensions);
+    for (size_t i = 0; i < dimensions; i++)
+    {
+        x[i] = (i % 17) * 0.1 - 0.8;
+    }
+    measure("tf::sphere(1000)", [&](size_t) { sink = sink + tf::sphere(x); });
+    measure("tf::ellipsoid(1000)", [&](size_t) { sink = sink + tf::ellipsoid(x); });
+    measure("tf::zakharov(1000)", [&](size_t) { sink = sink + tf::zakharov(x); });
+    measure("tf::rosenbrock(1000)", [&](size_t) { sink = sink + tf::rosenbrock(x); });
+    measure("tf::ackley(1000)", [&](size_t) { sink = sink + tf::ackley(x); });
+    measure("tf::griewangk(1000)", [&](size_t) { sink = sink + tf::griewangk(x); });
+    measure("tf::rastrigin(1000)", [&](size_t) { sink = sink + tf::rastrigin(x); });
+    benchmarkBatch();
+    benchmarkIndividualFunction();
+}
+
+// Rastrigin with 1000 variables of 32 bits, mutated with the usual 1% per
+// bit.
+void Benchmark::benchmarkIndividualFunction()
+{
+    IndividualFunction individual(tf::rastrigin, -5.12, 5.12, 32, 1000), partner = individual;
+    individual.setSeed(1);
+    individual.initRandom();
+    partner.setSeed(2);
+    partner.initRandom();
+    measure("individualFunction.mutate+getFenotype(1000x32)", [&](size_t) {
+        individual.mutate(1);
+        sink = sink + individual.getFenotype()[0];
+    });
+    measure("individualFunction.cross+getFenotype(1000x32)", [&](size_t i) {
+        individual.cross(partner, i % individual.getGenotypeLength());
+        sink = sink + individual.getFenotype()[0];
+    });
+    measure("individualFunction.getDistance(1000x32)", [&](size_t) {
+        sink = sink + individual.getDistance(partner);
+    });
+    GeneticAlgorithm<IndividualFunction> ga(individual, 50, 1, 80, 0);
+    ga.setSeed(1);
+    ga.initPoblation();
+    ga.improvePopulation();
+    measure("ga.nextGeneration(rastrigin 1000x32, P=50)", [&](size_t) {
+        ga.nextGeneration(5);
+    });
+}
+
+// The batch versions score a population of 64 points of 1000 variables; the
+// time is reported per point so it compares with the single versions.
+void Benchmark::benchmarkBatch()
+{
+    const size_t dimensions = 1000, count = 64;
+    std::vector<double> x(dimensions * count), fitness(count);
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        x[i] = (i % 17) * 0.1 - 0.8;
+    }
+    typedef void (*BatchFunction)(const double *, size_t, size_t, double *);
+    const std::pair<const char *, BatchFunction> functions[] = {
+        {"sphere", tf::sphere}, {"ellipsoid", tf::ellipsoid}, {"zakharov", tf::zakharov}, {"rosenbrock", tf::rosenbrock},
+        {"ackley", tf::ackley}, {"griewangk", tf::griewangk}, {"rastrigin", tf::rastrigin}};
+    for (auto &f : functions)
+    {
+        measure(std::string("tf::") + f.first + "[" + tf::getInstructionSet() + "](1000x64)", [&](size_t) {
+            f.second(x.data(), dimensions, count, fitness.data());
+            sink = sink + fitness[0];
+        }, count);
+    }
+}
+
+// The Sudoku benchmarks are compiled for the block size of the puzzle, as in
+// macro; an unsupported puzzle only skips them.
+void Benchmark::micro(const std::string &filename)
+{
+    auto instance = std::make_shared<const SudokuInstance>(filename);
+    if (!instance->isValid() || !dispatchBlockSize(*instance, [&](auto size) {
+            benchmarkSudoku<decltype(size)::value>(instance);
+            benchmarkReplacement<decltype(size)::value>(instance);
+        }))
+    {
+        std::cout << "{\"type\":\"error\",\"puzzle\":\"" << filename << "\",\"size\":" << instance->getSize() << "}" << std::endl;
+    }
+    benchmarkTestFunctions();
+}
+
+double Benchmark::percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+void Benchmark::macro(const std::vector<std::string> &filenames, int runs, double maxSeconds)
+{
+    for (auto &filename : filenames)
+    {
+        auto instance = std::make_shared<const SudokuInstance>(filename);
+        if (!dispatchBlockSize(*instance, [&](auto size) { benchmarkRuns<decltype(size)::value>(filename, instance, runs, maxSeconds); }))
+        {
+            std::cout << "{\"type\":\"error\",\"puzzle\":\"" << filename << "\",\"size\":" << instance->getSize() << "}" << std::endl;
+        }
+    }
+}
+
+template<size_t B>
+void Benchmark::benchmarkRuns(const std::string &filename, std::shared_ptr<const SudokuInstance> instance, int runs, double maxSeconds)
+{
+    BasicSudoku<B> sudoku(instance);
+    GeneticAlgorithm<BasicSudoku<B>> ga(sudoku, 50, 1, 80, 0);
+    std::vector<double> times;
+    int solved = 0;
+    long totalGenerations = 0;
+    for (int seed = 1; seed <= runs; seed++)
+    {
+        ga.setSeed(seed);
+        ga.initPoblation();
+        auto start = std::chrono::steady_clock::now();
+        int generations = ga.run(maxSeconds);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double fitness = ga.getBest().getFitness();
+        times.push_back(seconds);
+        solved += fitness == 0;
+        totalGenerations += generations;
+        std::cout << "{\"type\":\"run\",\"puzzle\":\"" << filename << "\",\"seed\":" << seed
+                  << ",\"generations\":" << generations << ",\"seconds\":" << seconds
+                  << ",\"fitness\":" << fitness << ",\"solved\":" << (fitness == 0 ? "true" : "false") << "}" << std::endl;
+    }
+    double total = 0;
+    for (auto t : times)
+    {
+        total += t;
+    }
+    std::cout << "{\"type\":\"summary\",\"puzzle\":\"" << filename << "\",\"runs\":" << runs << ",\"solved\":" << solved
+              << ",\"seconds_min\":" << percentile(times, 0) << ",\"seconds_median\":" << percentile(times, .5)
+              << ",\"seconds_p90\":" << percentile(times, .9) << ",\"seconds_max\":" << percentile(times, 1)
+              << ",\"generations_per_second\":" << (total > 0 ? totalGenerations / total : 0) << "}" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Uso: benchmark micro sudoku [segundos]" << std::endl;
+        std::cout << "     benchmark macro repeticiones segundos sudoku..." << std::endl;
+        return -1;
+    }
+    std::string mode = argv[1];
+    if (mode == "micro")
+    {
+        Benchmark benchmark(argc > 3 ? atof(argv[3]) : .2);
+        benchmark.micro(argv[2]);
+        return 0;
+    }
+    if (mode == "macro" && argc > 4)
+    {
+        Benchmark benchmark(0);
+        benchmark.macro(std::vector<std::string>(argv + 4, argv + argc), atoi(argv[2]), atof(argv[3]));
+        return 0;
+    }
+    std::cout << "Modo desconocido: " << mode << std::endl;
+    return -1;
+}
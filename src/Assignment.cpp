@@ -0,0 +1,71 @@
+#include "Assignment.hpp"
+
+void Assignment::resize(size_t n)
+{
+    this->n = n;
+    costs.resize(n * n);
+}
+
+int Assignment::solve()
+{
+    const int inf = std::numeric_limits<int>::max() / 2;
+    u.assign(n + 1, 0);
+    v.assign(n + 1, 0);
+    p.assign(n + 1, 0);
+    way.assign(n + 1, 0);
+    for (size_t i = 1; i <= n; i++)
+    {
+        p[0] = i;
+        size_t j0 = 0;
+        minv.assign(n + 1, inf);
+        used.assign(n + 1, false);
+        do
+        {
+            used[j0] = true;
+            size_t i0 = p[j0], j1 = 0;
+            int delta = inf;
+            for (size_t j = 1; j <= n; j++)
+            {
+                if (!used[j])
+                {
+                    int cur = costs[(i0 - 1) * n + j - 1] - u[i0] - v[j];
+                    if (cur < minv[j])
+                    {
+                        minv[j] = cur;
+                        way[j] = j0;
+                    }
+                    if (minv[j] < delta)
+                    {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+            }
+            for (size_t j = 0; j <= n; j++)
+            {
+                if (used[j])
+                {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do
+        {
+            size_t j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    column.resize(n);
+    for (size_t j = 1; j <= n; j++)
+    {
+        column[p[j] - 1] = j - 1;
+    }
+    return -v[0];
+}
@@ -0,0 +1,33 @@
+#ifndef ASSIGNMENT_HPP
+#define ASSIGNMENT_HPP
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+
+// Minimum cost assignment of n rows to n columns with the Hungarian
+// algorithm in O(n^3). The work arrays are kept between calls.
+class Assignment
+{
+private:
+  size_t n;
+  std::vector<int> costs;
+  std::vector<size_t> column;
+  std::vector<int> u;
+  std::vector<int> v;
+  std::vector<int> minv;
+  std::vector<size_t> p;
+  std::vector<size_t> way;
+  std::vector<bool> used;
+
+public:
+  Assignment() : n(0) {}
+
+  void resize(size_t n);
+  int &cost(size_t i, size_t j) { return costs[i * n + j]; }
+  size_t getColumn(size_t i) const { return column[i]; }
+
+  int solve();
+};
+
+#endif // ASSIGNMENT_HPP
@@ -0,0 +1,123 @@
+#include "BatchSolver.hpp"
+
+BatchSolver::BatchSolver(size_t threads, const Budget &budget, uint64_t seed)
+    : pool(threads), budget(budget), seed(seed)
+{
+    std::get<0>(workers).resize(pool.getThreads());
+    std::get<1>(workers).resize(pool.getThreads());
+    std::get<2>(workers).resize(pool.getThreads());
+}
+
+size_t BatchSolver::getPuzzleNumber() const
+{
+    return puzzles.size();
+}
+
+bool BatchSolver::load(const std::string &path)
+{
+    PuzzleReader reader;
+    std::vector<PuzzleReader::Puzzle> read;
+    if (path == "-")
+    {
+        std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        if (!reader.read("stdin", input.data(), input.size(), read))
+        {
+            return false;
+        }
+        addPuzzles("stdin", read);
+        return true;
+    }
+    DIR *dir = opendir(path.c_str());
+    if (dir != nullptr)
+    {
+        closedir(dir);
+        return readDirectory(path);
+    }
+    if (!reader.readFile(path, read))
+    {
+        return false;
+    }
+    addPuzzles(path, read);
+    return true;
+}
+
+// Files that cannot be read are reported and skipped.
+bool BatchSolver::readDirectory(const std::string &path)
+{
+    DIR *dir = opendir(path.c_str());
+    std::vector<std::string> filenames;
+    for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir))
+    {
+        std::string filename = entry->d_name;
+        if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".txt") == 0)
+        {
+            filenames.push_back(path + "/" + filename);
+        }
+    }
+    closedir(dir);
+    std::sort(filenames.begin(), filenames.end());
+    PuzzleReader reader;
+    std::vector<PuzzleReader::Puzzle> read;
+    for (auto &filename : filenames)
+    {
+        read.clear();
+        if (reader.readFile(filename, read))
+        {
+            addPuzzles(filename, read);
+        }
+    }
+    return true;
+}
+
+// A file with a single puzzle is named after the file, otherwise every puzzle
+// is named file:line.
+void BatchSolver::addPuzzles(const std::string &name, std::vector<PuzzleReader::Puzzle> &read)
+{
+    for (auto &puzzle : read)
+    {
+        names.push_back(read.size() == 1 ? name : name + ":" + std::to_string(puzzle.line));
+        puzzles.push_back(std::make_shared<const SudokuInstance>(puzzle.board));
+    }
+}
+
+template<size_t B>
+void BatchSolver::solvePuzzle(size_t puzzle, size_t worker, std::ostream &output)
+{
+    BasicSudoku<B> sudoku(puzzles[puzzle]);
+    std::unique_ptr<GeneticAlgorithm<BasicSudoku<B>>> &slot = std::get<B - 3>(workers)[worker];
+    if (!slot)
+    {
+        slot.reset(new GeneticAlgorithm<BasicSudoku<B>>(sudoku, 50, 1, 80, 0));
+    }
+    else
+    {
+        slot->setIndividual(sudoku);
+    }
+    GeneticAlgorithm<BasicSudoku<B>> &ga = *slot;
+    ga.setSeed(seed + puzzle);
+    auto start = std::chrono::steady_clock::now();
+    ga.initPoblation();
+    int generations = ga.run(budget);
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    const BasicSudoku<B> &best = ga.getBest();
+    const auto &solution = best.getSolution();
+    std::string cells;
+    for (size_t i = 0; i < solution.getSize() * solution.getSize(); i++)
+    {
+        cells += std::to_string(solution.data()[i]);
+        cells += solution.getSize() > 9 ? " " : "";
+    }
+    std::lock_guard<std::mutex> lock(outputMutex);
+    output << names[puzzle] << " " << best.getFitness() << " " << generations << " " << milliseconds << " " << cells << std::endl;
+}
+
+void BatchSolver::solve(std::ostream &output)
+{
+    pool.run(puzzles.size(), [this, &output](size_t puzzle, size_t worker) {
+        if (!dispatchBlockSize(*puzzles[puzzle], [&](auto size) { solvePuzzle<decltype(size)::value>(puzzle, worker, output); }))
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            output << names[puzzle] << " tamano no soportado" << std::endl;
+        }
+    });
+}
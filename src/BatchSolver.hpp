@@ -0,0 +1,50 @@
+#ifndef BATCH_SOLVER_HPP
+#define BATCH_SOLVER_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <tuple>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+
+#include <dirent.h>
+
+#include "Sudoku.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "WorkStealingPool.hpp"
+#include "PuzzleReader.hpp"
+
+// Solves many puzzles concurrently. Every worker keeps one genetic algorithm
+// per board size and reuses its populations for all the puzzles it takes. Results are
+// written as soon as each puzzle finishes, one line per puzzle:
+// name fitness generations milliseconds solution
+class BatchSolver
+{
+private:
+  WorkStealingPool pool;
+  Budget budget;
+  uint64_t seed;
+  std::vector<std::string> names;
+  std::vector<std::shared_ptr<const SudokuInstance>> puzzles;
+  template<size_t B>
+  using Workers = std::vector<std::unique_ptr<GeneticAlgorithm<BasicSudoku<B>>>>;
+  std::tuple<Workers<3>, Workers<4>, Workers<5>> workers;
+  std::mutex outputMutex;
+
+  bool readDirectory(const std::string &path);
+  void addPuzzles(const std::string &name, std::vector<PuzzleReader::Puzzle> &read);
+  template<size_t B>
+  void solvePuzzle(size_t puzzle, size_t worker, std::ostream &output);
+
+public:
+  BatchSolver(size_t threads, const Budget &budget, uint64_t seed);
+  bool load(const std::string &path);
+  size_t getPuzzleNumber() const;
+  void solve(std::ostream &output);
+};
+
+#endif // BATCH_SOLVER_HPP
@@ -0,0 +1,45 @@
+#ifndef BUDGET_HPP
+#define BUDGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// Limits of a run. The run stops as soon as any limit is reached; a limit of
+// zero (or negative seconds) is not checked, so a budget without limits runs
+// until the puzzle is solved. When the
+// best fitness has not improved for stagnation generations the worst
+// restartFraction of the population is initialized again (zero disables the
+// restarts).
+struct Budget
+{
+  double seconds;
+  uint64_t evaluations;
+  size_t generations;
+  size_t stagnation;
+  double restartFraction;
+
+  Budget(double seconds = 1800) : seconds(seconds), evaluations(0), generations(0), stagnation(0), restartFraction(.5) {}
+
+  // Fraction of the budget already used, the largest over the limits.
+  double getProgress(double elapsed, uint64_t evaluated, size_t generation) const
+  {
+    double progress = seconds > 0 ? elapsed / seconds : 0;
+    if (evaluations > 0)
+    {
+      progress = std::max(progress, (double)evaluated / evaluations);
+    }
+    if (generations > 0)
+    {
+      progress = std::max(progress, (double)generation / generations);
+    }
+    return progress;
+  }
+
+  bool isExhausted(double elapsed, uint64_t evaluated, size_t generation) const
+  {
+    return getProgress(elapsed, evaluated, generation) >= 1;
+  }
+};
+
+#endif // BUDGET_HPP
@@ -0,0 +1,38 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of a GeneticAlgorithm checkpoint: this header followed by one record
+// per individual. Records have a fixed size, a multiple of 8 bytes, so a
+// mapped file can be read in place. Values are stored in native byte order.
+namespace checkpoint
+{
+const char magic[8] = {'G', 'A', 'C', 'K', 'P', 'T', 0, 0};
+const uint32_t version = 2;
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t populationSize;
+  uint64_t genotypeLength;
+  uint64_t generation;
+  double elapsedSeconds;
+  double initialD;
+  uint64_t evaluations;
+  uint64_t lastImprovement;
+  uint64_t random[4];
+};
+
+static_assert(sizeof(Header) % 8 == 0, "records must stay 8 byte aligned");
+
+inline size_t getRecordSize(size_t stateSize)
+{
+  return (stateSize + 7) / 8 * 8;
+}
+}
+
+#endif // CHECKPOINT_HPP
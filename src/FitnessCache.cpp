@@ -0,0 +1,77 @@
+#include "FitnessCache.hpp"
+
+#include <cstring>
+
+namespace
+{
+uint64_t toBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+}
+
+FitnessCache::FitnessCache(size_t capacity) : hits(0), misses(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+    entries = std::vector<Entry>(size);
+    mask = size - 1;
+    clear();
+}
+
+bool FitnessCache::find(uint64_t hash, double &fitness)
+{
+    Entry &entry = entries[hash & mask];
+    uint64_t bits = entry.fitness.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ bits) != hash)
+    {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    std::memcpy(&fitness, &bits, sizeof fitness);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FitnessCache::insert(uint64_t hash, double fitness)
+{
+    Entry &entry = entries[hash & mask];
+    uint64_t bits = toBits(fitness);
+    entry.check.store(hash ^ bits, std::memory_order_relaxed);
+    entry.fitness.store(bits, std::memory_order_relaxed);
+}
+
+// Empty slots hold a check that matches no hash stored in that slot.
+void FitnessCache::clear()
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        entries[i].check.store(~i, std::memory_order_relaxed);
+        entries[i].fitness.store(0, std::memory_order_relaxed);
+    }
+    hits = 0;
+    misses = 0;
+}
+
+uint64_t FitnessCache::getHits() const
+{
+    return hits.load(std::memory_order_relaxed);
+}
+
+uint64_t FitnessCache::getMisses() const
+{
+    return misses.load(std::memory_order_relaxed);
+}
+
+// splitmix64 finalizer.
+uint64_t FitnessCache::mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,44 @@
+#ifndef FITNESS_CACHE_HPP
+#define FITNESS_CACHE_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded map from genotype hashes to fitness values that any number of
+// threads can read and write without locks. Each hash has a single slot, and
+// a new entry replaces whatever the slot held. A slot stores the fitness and
+// the hash xored with it, so an entry torn by a concurrent write does not
+// match its hash and is treated as a miss. Two genotypes with the same 64 bit
+// hash share their fitness.
+class FitnessCache
+{
+private:
+  struct Entry
+  {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> fitness;
+  };
+
+  std::vector<Entry> entries;
+  size_t mask;
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+
+public:
+  // The capacity is rounded up to a power of two.
+  FitnessCache(size_t capacity);
+
+  bool find(uint64_t hash, double &fitness);
+  void insert(uint64_t hash, double fitness);
+  void clear();
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+
+  // Mixes the bits of z, for building genotype hashes.
+  static uint64_t mix(uint64_t z);
+};
+
+#endif // FITNESS_CACHE_HPP
@@ -4,18 +4,35 @@
 #include <vector>
 #include <memory>
 #include <cstddef>
-#include <random>
 #include <iostream>
 #include <algorithm>
 #include <chrono>
 #include <set>
 #include <type_traits>
+#include <limits>
+#include <numeric>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
 
-//#include "Individual.hpp"
+#include "ThreadPool.hpp"
+#include "Random.hpp"
+#include "Telemetry.hpp"
+#include "Checkpoint.hpp"
+#include "MappedFile.hpp"
+#include "Budget.hpp"
+
+#include "Individual.hpp"
 
 template<class T>
 class GeneticAlgorithm
 {
+  static_assert(IsIndividual<T>::value, "T must derive from Individual<T> and provide the operators listed by IsIndividual");
+
 private:
   size_t genotypeLength;
   double mutationProbability;
@@ -25,26 +42,84 @@ private:
   size_t populationSize;
   std::vector<T> population;
   std::vector<T> offspring;
+  std::vector<T> nextPopulation;
+
+  std::vector<T *> candidates;
+  std::vector<double> candidateDCN;
+  std::vector<size_t> order;
+  std::vector<size_t> front;
+
+  Random gen;
+
+  std::unique_ptr<ThreadPool> pool;
 
-  std::random_device rd;
-  std::mt19937 gen;
-  std::uniform_int_distribution<> randPopulation;
-  std::uniform_int_distribution<> randGenotype;
-  std::uniform_real_distribution<> randProb;
+  bool steadyState;
+  std::vector<std::mutex> slotMutex;
+  std::vector<std::atomic<double>> slotFitness;
+  std::atomic<bool> solved;
+  std::atomic<size_t> children;
+  std::atomic<uint64_t> evaluated;
+
+  double initialD;
+  double elapsedSeconds;
+  bool resumed;
+  std::string checkpointFile;
+  size_t checkpointInterval;
+
+  uint64_t evaluations;
+  size_t lastImprovement;
+  double bestFitness;
+
+  size_t generation;
+  std::function<void(const telemetry::GenerationStats &)> observer;
+#ifdef GA_TELEMETRY
+  double phaseSeconds[telemetry::PhaseCount];
+  uint64_t lastCounters[telemetry::CounterCount];
+#endif
+
+  template<class F>
+  void forEach(size_t begin, size_t end, F f);
 
   void tournament(size_t n);
   void crossover();
+  void seedOffspring();
   void mutation();
+  void localSearch(std::vector<T> &individuals);
   void calcFitness();
+  bool evaluate(T &individual);
   void elitism();
   void multiDynamic(double D);
+  void restartPopulation(double fraction);
+  void checkStagnation(const Budget &budget);
+
+  void nonDominated();
+  void notifyObserver(double seconds, uint64_t allocations);
+  void resetTelemetry();
 
-  std::vector<size_t> nonDominated(std::vector<T> individuals);
+  size_t selectSlot(Random &random) const;
+  void evolveSteadyState(uint64_t seed, std::chrono::steady_clock::time_point start, const Budget &budget, T *buffers);
+  int runSteadyState(const Budget &budget);
 
 public:
   GeneticAlgorithm(const T &individual, size_t populationSize, double mutationProbability, double crossoverProbability, size_t eliteNumber);
+  void setThreads(size_t threads);
+  void setSeed(uint64_t seed);
+  void setIndividual(const T &individual);
+  void setObserver(std::function<void(const telemetry::GenerationStats &)> observer);
+  void setSteadyState(bool steadyState);
+  void setCheckpoint(const std::string &filename, size_t interval);
+  bool saveCheckpoint(const std::string &filename) const;
+  bool loadCheckpoint(const std::string &filename);
   void initPoblation();
-  int run(int maxSeconds);
+  void improvePopulation();
+  void nextGeneration(double D);
+  // The two halves of nextGeneration, for callers that measure them apart.
+  void createOffspring();
+  void replacement(double D);
+  void immigrate(const T &individual);
+  int run(const Budget &budget);
+  int run(double maxSeconds);
+  uint64_t getEvaluations() const;
   const T &getBest();
 };
 
@@ -5,9 +5,75 @@ GeneticAlgorithm<T>::GeneticAlgorithm(
     const T &individual, size_t populationSize, double mutationProbability, double crossoverProbability, size_t eliteNumber)
     : genotypeLength(individual.getGenotypeLength()), mutationProbability(mutationProbability),
       crossoverProbability(crossoverProbability), eliteNumber(eliteNumber),
-      populationSize(populationSize), population(populationSize, individual), offspring(populationSize),
-      rd(), gen(rd()), randPopulation(0, populationSize - 1), randGenotype(0, genotypeLength - 1), randProb(0, 100)
+      populationSize(populationSize), population(populationSize, individual), offspring(populationSize, individual),
+      nextPopulation(populationSize, individual),
+      gen(Random::randomSeed()), steadyState(false), slotMutex(populationSize), slotFitness(populationSize),
+      solved(false), children(0), evaluated(0), initialD(10), elapsedSeconds(0), resumed(false), checkpointInterval(0),
+      evaluations(0), lastImprovement(0), bestFitness(std::numeric_limits<double>::max()), generation(0)
 {
+    candidates.reserve(2 * populationSize);
+    candidateDCN.reserve(2 * populationSize);
+    order.reserve(2 * populationSize);
+    front.reserve(2 * populationSize);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setThreads(size_t threads)
+{
+    pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setSeed(uint64_t seed)
+{
+    gen.seed(seed);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setIndividual(const T &individual)
+{
+    genotypeLength = individual.getGenotypeLength();
+    for (auto &p : population)
+    {
+        p = individual;
+    }
+    for (auto &o : offspring)
+    {
+        o = individual;
+    }
+    for (auto &n : nextPopulation)
+    {
+        n = individual;
+    }
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setObserver(std::function<void(const telemetry::GenerationStats &)> observer)
+{
+    this->observer = observer;
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setSteadyState(bool steadyState)
+{
+    this->steadyState = steadyState;
+}
+
+template<class T>
+template<class F>
+void GeneticAlgorithm<T>::forEach(size_t begin, size_t end, F f)
+{
+    if (pool)
+    {
+        pool->parallelFor(begin, end, f);
+    }
+    else
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            f(i);
+        }
+    }
 }
 
 template<class T>
@@ -15,8 +81,121 @@ void GeneticAlgorithm<T>::initPoblation()
 {
     for (auto &i : population)
     {
+        i.setSeed(gen());
         i.initRandom();
     }
+    generation = 0;
+    elapsedSeconds = 0;
+    evaluations = 0;
+    lastImprovement = 0;
+    resumed = false;
+    resetTelemetry();
+}
+
+template<class T>
+void GeneticAlgorithm<T>::resetTelemetry()
+{
+#ifdef GA_TELEMETRY
+    std::fill(phaseSeconds, phaseSeconds + telemetry::PhaseCount, 0);
+    for (size_t c = 0; c < telemetry::CounterCount; c++)
+    {
+        lastCounters[c] = telemetry::getCounter(telemetry::Counter(c));
+    }
+#endif
+}
+
+template<class T>
+void GeneticAlgorithm<T>::setCheckpoint(const std::string &filename, size_t interval)
+{
+    checkpointFile = filename;
+    checkpointInterval = interval;
+}
+
+// The file is written next to its destination and renamed over it, so an
+// interrupted write never leaves a truncated checkpoint behind.
+template<class T>
+bool GeneticAlgorithm<T>::saveCheckpoint(const std::string &filename) const
+{
+    checkpoint::Header header = {};
+    std::copy(checkpoint::magic, checkpoint::magic + sizeof header.magic, header.magic);
+    header.version = checkpoint::version;
+    header.recordSize = checkpoint::getRecordSize(population[0].getStateSize());
+    header.populationSize = populationSize;
+    header.genotypeLength = genotypeLength;
+    header.generation = generation;
+    header.elapsedSeconds = elapsedSeconds;
+    header.initialD = initialD;
+    header.evaluations = evaluations;
+    header.lastImprovement = lastImprovement;
+    gen.getState(header.random);
+    std::string temporary = filename + ".tmp";
+    std::ofstream file(temporary, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "No se pudo abrir el archivo: " << temporary << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof header);
+    std::vector<uint8_t> record(header.recordSize);
+    for (auto &p : population)
+    {
+        std::fill(record.begin(), record.end(), 0);
+        p.saveState(record.data());
+        file.write(reinterpret_cast<const char *>(record.data()), record.size());
+    }
+    file.close();
+    if (!file || std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        std::cout << "No se pudo escribir el archivo: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The individuals are read into nextPopulation and only become the
+// population once every record has been accepted.
+template<class T>
+bool GeneticAlgorithm<T>::loadCheckpoint(const std::string &filename)
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        return false;
+    }
+    checkpoint::Header header;
+    size_t recordSize = checkpoint::getRecordSize(population[0].getStateSize());
+    if (file.size() < sizeof header)
+    {
+        std::cout << "Checkpoint invalido: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof header);
+    if (std::memcmp(header.magic, checkpoint::magic, sizeof header.magic) != 0 || header.version != checkpoint::version ||
+        header.recordSize != recordSize || header.populationSize != populationSize || header.genotypeLength != genotypeLength ||
+        file.size() != sizeof header + populationSize * recordSize)
+    {
+        std::cout << "Checkpoint invalido: " << filename << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < populationSize; i++)
+    {
+        nextPopulation[i] = population[i];
+        if (!nextPopulation[i].loadState(file.data() + sizeof header + i * recordSize))
+        {
+            std::cout << "Checkpoint invalido: " << filename << std::endl;
+            return false;
+        }
+    }
+    population.swap(nextPopulation);
+    generation = header.generation;
+    elapsedSeconds = header.elapsedSeconds;
+    initialD = header.initialD;
+    evaluations = header.evaluations;
+    lastImprovement = header.lastImprovement;
+    gen.setState(header.random);
+    resumed = true;
+    resetTelemetry();
+    return true;
 }
 
 template<class T>
@@ -24,11 +203,11 @@ void GeneticAlgorithm<T>::tournament(size_t n)
 {
     for (size_t i = eliteNumber; i < populationSize; i++)
     {
-        size_t selected = randPopulation(gen);
+        size_t selected = gen.below(populationSize);
         double min = population[selected].getFitness();
         for (size_t j = 0; j < n - 1; j++)
         {
-            size_t k = randPopulation(gen);
+            size_t k = gen.below(populationSize);
             if (population[k].getFitness() < min)
             {
                 selected = k;
@@ -45,10 +224,10 @@ void GeneticAlgorithm<T>::crossover()
     T *aux;
     for (size_t i = eliteNumber; i < populationSize - 1; i += 2)
     {
-        if (randProb(gen) < crossoverProbability)
+        if (gen.uniform(0, 100) < crossoverProbability)
         {
             aux = &offspring[i];
-            size_t pos = randGenotype(gen);
+            size_t pos = gen.below(genotypeLength);
             offspring[i].cross(offspring[i + 1], pos);
             offspring[i + 1].cross(*aux, pos);
         }
@@ -56,21 +235,59 @@ void GeneticAlgorithm<T>::crossover()
 }
 
 template<class T>
-void GeneticAlgorithm<T>::mutation()
+void GeneticAlgorithm<T>::seedOffspring()
 {
-    for (size_t i = eliteNumber; i < populationSize; i++)
+    for (auto &o : offspring)
     {
-        offspring[i].mutate(mutationProbability);
+        o.setSeed(gen());
     }
 }
 
+template<class T>
+void GeneticAlgorithm<T>::mutation()
+{
+    forEach(eliteNumber, populationSize, [this](size_t i) {
+        offspring[i].mutate(mutationProbability);
+    });
+}
+
+template<class T>
+void GeneticAlgorithm<T>::localSearch(std::vector<T> &individuals)
+{
+    std::atomic<uint64_t> evaluated(0);
+    forEach(0, individuals.size(), [&individuals, &evaluated](size_t i) {
+        evaluated.fetch_add(individuals[i].stochasticLocalSearch(20), std::memory_order_relaxed);
+    });
+    evaluations += evaluated;
+    GA_COUNT(FitnessEvaluations, evaluated);
+}
+
 template<class T>
 void GeneticAlgorithm<T>::calcFitness()
 {
-    for (size_t i = eliteNumber; i < populationSize; i++)
+    std::atomic<size_t> evaluated(0);
+    forEach(eliteNumber, populationSize, [this, &evaluated](size_t i) {
+        if (evaluate(offspring[i]))
+        {
+            evaluated.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    evaluations += evaluated;
+    GA_COUNT(FitnessEvaluations, evaluated);
+}
+
+// Individuals whose genotype did not change since their fitness was computed
+// (copies left alone by crossover and mutation, or already scored by the
+// local search) keep it. Returns whether the fitness function ran.
+template<class T>
+bool GeneticAlgorithm<T>::evaluate(T &individual)
+{
+    if (!individual.isDirty())
     {
-        offspring[i].setFitness();
+        return false;
     }
+    individual.setFitness();
+    return true;
 }
 
 template<class T>
@@ -83,92 +300,351 @@ void GeneticAlgorithm<T>::elitism()
     }
 }
 
+// Survivors are swapped out of the candidates into nextPopulation, which then
+// becomes the population. Both buffers keep their individuals, and the
+// individuals keep their storage, from one generation to the next. The
+// distances to each new survivor take microseconds, so they are updated on
+// the calling thread rather than dispatched to the pool once per survivor.
 template<class T>
 void GeneticAlgorithm<T>::multiDynamic(double D)
 {
     size_t i;
     size_t c;
-    std::vector<size_t> nd;
-    std::vector<T> newPop;
-    newPop.reserve(populationSize);
-    std::vector<T> currentMembers = population;
-    currentMembers.reserve(2 * populationSize);
-    currentMembers.insert(currentMembers.end(), offspring.begin(), offspring.end());
-    typename std::vector<T>::iterator best = std::min_element(currentMembers.begin(), currentMembers.end());
-    newPop.push_back(*best);
-    currentMembers.erase(best);
-    while (newPop.size() < populationSize)
-    {
-        for (auto &cm : currentMembers)
-        {
-            cm.setDCN(newPop);
-        }
-        nd = nonDominated(currentMembers);
+    size_t survivors = 0;
+    candidates.clear();
+    for (auto &p : population)
+    {
+        candidates.push_back(&p);
+    }
+    for (auto &o : offspring)
+    {
+        candidates.push_back(&o);
+    }
+    candidateDCN.assign(candidates.size(), std::numeric_limits<double>::max());
+    i = std::min_element(candidates.begin(), candidates.end(), [](const T *a, const T *b) { return *a < *b; }) - candidates.begin();
+    while (true)
+    {
+        std::swap(nextPopulation[survivors++], *candidates[i]);
+        candidates[i] = candidates.back();
+        candidates.pop_back();
+        candidateDCN[i] = candidateDCN.back();
+        candidateDCN.pop_back();
+        if (survivors == populationSize)
+        {
+            break;
+        }
+        const T &survivor = nextPopulation[survivors - 1];
+        for (size_t j = 0; j < candidates.size(); j++)
+        {
+            candidateDCN[j] = std::min(candidateDCN[j], candidates[j]->getDistance(survivor));
+        }
+        nonDominated();
         c = 0;
         do
         {
-            i = rand() % nd.size();
+            i = front[gen.below(front.size())];
             c++;
-        } while (currentMembers[nd[i]].getDCN() < D && c < nd.size());
-        newPop.push_back(currentMembers[nd[i]]);
-        currentMembers.erase(currentMembers.begin() + nd[i]);
+        } while (candidateDCN[i] < D && c < front.size());
     }
-    population = newPop;
+    population.swap(nextPopulation);
 }
 
+// The best individuals are kept; the others get a new random genotype and
+// the same local search as the initial population. initRandom scores each
+// new genotype, which counts as one evaluation.
 template<class T>
-std::vector<size_t> GeneticAlgorithm<T>::nonDominated(std::vector<T> individuals)
+void GeneticAlgorithm<T>::restartPopulation(double fraction)
 {
-    std::vector<size_t> nd;
-    for (size_t i = 0; i < individuals.size(); i++)
+    size_t kept = std::max<size_t>(1, populationSize - (size_t)(fraction * populationSize));
+    std::sort(population.begin(), population.end());
+    for (size_t i = kept; i < populationSize; i++)
     {
-        bool nonDominated = true;
-        for (size_t j = 0; j < individuals.size(); j++)
+        population[i].setSeed(gen());
+        population[i].initRandom();
+    }
+    std::atomic<uint64_t> evaluated(populationSize - kept);
+    forEach(kept, populationSize, [this, &evaluated](size_t i) {
+        evaluated.fetch_add(population[i].stochasticLocalSearch(20), std::memory_order_relaxed);
+    });
+    evaluations += evaluated;
+    GA_COUNT(FitnessEvaluations, evaluated);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::checkStagnation(const Budget &budget)
+{
+    double fitness = getBest().getFitness();
+    if (fitness < bestFitness)
+    {
+        bestFitness = fitness;
+        lastImprovement = generation;
+    }
+    else if (budget.stagnation > 0 && generation - lastImprovement >= budget.stagnation)
+    {
+        restartPopulation(budget.restartFraction);
+        lastImprovement = generation;
+    }
+}
+
+template<class T>
+void GeneticAlgorithm<T>::nonDominated()
+{
+    order.resize(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return candidates[a]->getFitness() < candidates[b]->getFitness();
+    });
+    front.clear();
+    double maxDCN = -std::numeric_limits<double>::max();
+    for (size_t first = 0; first < order.size();)
+    {
+        size_t last = first;
+        double groupDCN = maxDCN;
+        double fitness = candidates[order[first]]->getFitness();
+        for (; last < order.size() && candidates[order[last]]->getFitness() == fitness; last++)
         {
-            if (individuals[i].getFitness() > individuals[j].getFitness() && individuals[i].getDCN() < individuals[j].getDCN())
+            if (candidateDCN[order[last]] >= maxDCN)
             {
-                nonDominated = false;
-                break;
+                front.push_back(order[last]);
             }
+            groupDCN = std::max(groupDCN, candidateDCN[order[last]]);
         }
-        if (nonDominated)
-        {
-            nd.push_back(i);
-        }
+        maxDCN = groupDCN;
+        first = last;
     }
-    return nd;
 }
 
 template<class T>
-int GeneticAlgorithm<T>::run(int maxSeconds)
+void GeneticAlgorithm<T>::improvePopulation()
 {
-    double DI = 10;
-    int i = 0;
-    auto start = std::chrono::steady_clock::now();
+    localSearch(population);
+}
+
+// The clock and the allocation counter are only read when there is an
+// observer to report them to.
+template<class T>
+void GeneticAlgorithm<T>::nextGeneration(double D)
+{
+    bool observed = static_cast<bool>(observer);
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocations = 0;
+    if (observed)
+    {
+        start = std::chrono::steady_clock::now();
+        allocations = telemetry::getAllocations();
+    }
+    GA_TIMED(phaseSeconds[telemetry::Tournament], tournament(2));
+    GA_TIMED(phaseSeconds[telemetry::Crossover], crossover());
+    GA_TIMED(phaseSeconds[telemetry::Mutation], seedOffspring(); mutation());
+    GA_TIMED(phaseSeconds[telemetry::LocalSearch], localSearch(offspring));
+    GA_TIMED(phaseSeconds[telemetry::Fitness], calcFitness());
+    GA_TIMED(phaseSeconds[telemetry::Replacement], multiDynamic(D));
+    generation++;
+    if (observed)
+    {
+        notifyObserver(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                       telemetry::getAllocations() - allocations);
+    }
+}
+
+template<class T>
+void GeneticAlgorithm<T>::createOffspring()
+{
+    tournament(2);
+    crossover();
+    seedOffspring();
+    mutation();
+    localSearch(offspring);
+    calcFitness();
+}
+
+template<class T>
+void GeneticAlgorithm<T>::replacement(double D)
+{
+    multiDynamic(D);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::notifyObserver(double seconds, uint64_t allocations)
+{
+    telemetry::GenerationStats stats = {};
+    const T &best = getBest();
+    stats.generation = generation;
+    stats.seconds = seconds;
+    stats.allocations = allocations;
+    stats.bestFitness = best.getFitness();
     for (auto &p : population)
     {
-        p.stochasticLocalSearch(20);
+        stats.meanFitness += p.getFitness();
+        stats.diversity += p.getDistance(best);
+    }
+    stats.meanFitness /= populationSize;
+    stats.diversity /= populationSize;
+#ifdef GA_TELEMETRY
+    std::copy(phaseSeconds, phaseSeconds + telemetry::PhaseCount, stats.phaseSeconds);
+    std::fill(phaseSeconds, phaseSeconds + telemetry::PhaseCount, 0);
+    for (size_t c = 0; c < telemetry::CounterCount; c++)
+    {
+        uint64_t counter = telemetry::getCounter(telemetry::Counter(c));
+        stats.counters[c] = counter - lastCounters[c];
+        lastCounters[c] = counter;
     }
+#endif
+    observer(stats);
+}
+
+template<class T>
+void GeneticAlgorithm<T>::immigrate(const T &individual)
+{
+    *std::max_element(population.begin(), population.end()) = individual;
+}
+
+// D decreases linearly from initialD to zero as the budget is used up.
+template<class T>
+int GeneticAlgorithm<T>::run(const Budget &budget)
+{
+    if (steadyState)
+    {
+        return runSteadyState(budget);
+    }
+    double DI = initialD;
+    int i = 0;
+    auto start = std::chrono::steady_clock::now() -
+                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(elapsedSeconds));
+    auto elapsed = [start]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    if (!resumed)
+    {
+        improvePopulation();
+        if (getBest().getFitness() == 0)
+        {
+            return 0;
+        }
+    }
+    resumed = false;
+    bestFitness = getBest().getFitness();
     do
     {
-        tournament(2);
-        crossover();
-        mutation();
-        for (auto &o : offspring)
+        double progress = std::min(1., budget.getProgress(elapsed(), evaluations, generation));
+        nextGeneration(DI - DI * progress);
+        elapsedSeconds = elapsed();
+        if (checkpointInterval > 0 && generation % checkpointInterval == 0)
         {
-            o.stochasticLocalSearch(20);
+            saveCheckpoint(checkpointFile);
         }
-        calcFitness();
-        multiDynamic(DI - DI * (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count() / maxSeconds));
         if (getBest().getFitness() == 0)
         {
             return i;
         }
         i++;
-    } while (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count() < maxSeconds);
+        checkStagnation(budget);
+    } while (!budget.isExhausted(elapsed(), evaluations, generation));
     return i;
 }
 
+template<class T>
+int GeneticAlgorithm<T>::run(double maxSeconds)
+{
+    return run(Budget(maxSeconds));
+}
+
+template<class T>
+uint64_t GeneticAlgorithm<T>::getEvaluations() const
+{
+    return evaluations;
+}
+
+// Binary tournament over the fitness published for every slot.
+template<class T>
+size_t GeneticAlgorithm<T>::selectSlot(Random &random) const
+{
+    size_t a = random.below(populationSize), b = random.below(populationSize);
+    return slotFitness[b].load(std::memory_order_relaxed) < slotFitness[a].load(std::memory_order_relaxed) ? b : a;
+}
+
+// One worker of the steady-state mode. Parents are copied out under their
+// slot lock, the child is built and improved without any lock, and it then
+// replaces the parent closest to it if it is at least as fit as whoever
+// holds that slot by then (deterministic crowding).
+template<class T>
+void GeneticAlgorithm<T>::evolveSteadyState(uint64_t seed, std::chrono::steady_clock::time_point start, const Budget &budget, T *buffers)
+{
+    Random random(seed);
+    T &first = buffers[0], &second = buffers[1], &child = buffers[2];
+    while (!solved)
+    {
+        size_t born = children;
+        if (budget.isExhausted(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), evaluations + evaluated,
+                               born / populationSize))
+        {
+            break;
+        }
+        size_t a = selectSlot(random), b = selectSlot(random);
+        {
+            std::lock_guard<std::mutex> lock(slotMutex[a]);
+            first = population[a];
+        }
+        {
+            std::lock_guard<std::mutex> lock(slotMutex[b]);
+            second = population[b];
+        }
+        child = first;
+        child.setSeed(random());
+        if (random.uniform(0, 100) < crossoverProbability)
+        {
+            child.cross(second, random.below(genotypeLength));
+        }
+        child.mutate(mutationProbability);
+        uint64_t runs = child.stochasticLocalSearch(20) + evaluate(child);
+        evaluated.fetch_add(runs, std::memory_order_relaxed);
+        GA_COUNT(FitnessEvaluations, runs);
+        size_t target = child.getDistance(first) <= child.getDistance(second) ? a : b;
+        std::lock_guard<std::mutex> lock(slotMutex[target]);
+        if (child.getFitness() <= population[target].getFitness())
+        {
+            std::swap(population[target], child);
+            slotFitness[target].store(population[target].getFitness(), std::memory_order_relaxed);
+            solved = solved || population[target].getFitness() == 0;
+        }
+        children++;
+    }
+}
+
+// Every thread of the pool runs its own worker until the time is up or a
+// solution is found; no thread waits for the others between children. Runs
+// are only reproducible with one thread, and neither the observer, the
+// checkpoints nor the stagnation restarts are used.
+// Returns the number of children divided by the population size, comparable
+// to a generation count.
+template<class T>
+int GeneticAlgorithm<T>::runSteadyState(const Budget &budget)
+{
+    auto start = std::chrono::steady_clock::now();
+    improvePopulation();
+    if (getBest().getFitness() == 0)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < populationSize; i++)
+    {
+        slotFitness[i].store(population[i].getFitness(), std::memory_order_relaxed);
+    }
+    solved = false;
+    children = 0;
+    evaluated = 0;
+    size_t workers = pool ? pool->getThreads() : 1;
+    std::vector<uint64_t> seeds(workers);
+    for (auto &s : seeds)
+    {
+        s = gen();
+    }
+    std::vector<T> buffers(3 * workers, population[0]);
+    forEach(0, workers, [this, &seeds, &buffers, start, &budget](size_t w) {
+        evolveSteadyState(seeds[w], start, budget, &buffers[3 * w]);
+    });
+    evaluations += evaluated;
+    return children / populationSize;
+}
+
 template<class T>
 const T &GeneticAlgorithm<T>::getBest()
 {
@@ -0,0 +1,106 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+template<class T>
+class StridedView
+{
+private:
+  T *first;
+  size_t stride;
+
+public:
+  StridedView(T *first, size_t stride) : first(first), stride(stride) {}
+  T &operator[](size_t i) const { return first[i * stride]; }
+};
+
+template<class T>
+class BlockView
+{
+private:
+  T *first;
+  size_t size;
+  size_t step;
+
+public:
+  BlockView(T *first, size_t size, size_t step) : first(first), size(size), step(step) {}
+  T &operator[](size_t cell) const { return first[(cell / step) * size + cell % step]; }
+};
+
+// Square table stored row-major in a single contiguous buffer.
+template<class T>
+class Grid
+{
+private:
+  size_t size;
+  std::vector<T> cells;
+
+public:
+  Grid() : size(0) {}
+  Grid(size_t size, T value = T()) : size(size), cells(size * size, value) {}
+
+  size_t getSize() const { return size; }
+  T *data() { return cells.data(); }
+  const T *data() const { return cells.data(); }
+
+  T &operator()(size_t i, size_t j) { return cells[i * size + j]; }
+  const T &operator()(size_t i, size_t j) const { return cells[i * size + j]; }
+
+  T *row(size_t i) { return cells.data() + i * size; }
+  const T *row(size_t i) const { return cells.data() + i * size; }
+
+  StridedView<T> col(size_t j) { return StridedView<T>(cells.data() + j, size); }
+  StridedView<const T> col(size_t j) const { return StridedView<const T>(cells.data() + j, size); }
+
+  BlockView<T> block(size_t k, size_t l, size_t step) { return BlockView<T>(row(k) + l, size, step); }
+  BlockView<const T> block(size_t k, size_t l, size_t step) const { return BlockView<const T>(row(k) + l, size, step); }
+
+  void fill(T value) { cells.assign(cells.size(), value); }
+};
+
+typedef Grid<uint8_t> Board;
+
+// Square table with the same interface as Grid but a compile-time size. The
+// cells are stored inline, so an object holding one needs no heap memory.
+template<class T, size_t N>
+class FixedGrid
+{
+private:
+  std::array<T, N * N> cells;
+
+public:
+  FixedGrid() = default;
+  FixedGrid(const Grid<T> &grid) { *this = grid; }
+  FixedGrid &operator=(const Grid<T> &grid)
+  {
+    assert(grid.getSize() == N);
+    std::copy(grid.data(), grid.data() + N * N, cells.data());
+    return *this;
+  }
+
+  static constexpr size_t getSize() { return N; }
+  T *data() { return cells.data(); }
+  const T *data() const { return cells.data(); }
+
+  T &operator()(size_t i, size_t j) { return cells[i * N + j]; }
+  const T &operator()(size_t i, size_t j) const { return cells[i * N + j]; }
+
+  T *row(size_t i) { return cells.data() + i * N; }
+  const T *row(size_t i) const { return cells.data() + i * N; }
+
+  StridedView<T> col(size_t j) { return StridedView<T>(cells.data() + j, N); }
+  StridedView<const T> col(size_t j) const { return StridedView<const T>(cells.data() + j, N); }
+
+  BlockView<T> block(size_t k, size_t l, size_t step) { return BlockView<T>(row(k) + l, N, step); }
+  BlockView<const T> block(size_t k, size_t l, size_t step) const { return BlockView<const T>(row(k) + l, N, step); }
+
+  void fill(T value) { cells.fill(value); }
+};
+
+#endif // GRID_HPP
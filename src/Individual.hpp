@@ -2,35 +2,71 @@
 #define INDIVIDUAL_HPP
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstddef>
 #include <vector>
+#include <utility>
+#include <type_traits>
 
+// Common state of the individuals, used as Individual<Derived> (CRTP). The
+// algorithms are templated on the concrete type, so the genetic operators
+// are plain member functions of Derived, resolved at compile time and
+// inlined; IsIndividual lists the ones GeneticAlgorithm needs.
+template<class Derived>
 class Individual
 {
-private:
 protected:
   double fitness;
   double dcn;
+  // Set when the genotype changed after the fitness was computed.
+  bool dirty = true;
 
 public:
-  double getFitness() const;
+  double getFitness() const { return fitness; }
+  bool isDirty() const { return dirty; }
+  // Sets a fitness known for the current genotype, e.g. from a local search.
+  void restoreFitness(double fitness)
+  {
+    this->fitness = fitness;
+    dirty = false;
+  }
+  double getDCN() const { return dcn; }
 
-  virtual void initRandom() = 0;
-
-  virtual void setFitness() = 0;
-
-  virtual void mutate(double probability) = 0;
-
-  virtual void cross(const Individual &partner, const size_t pos) = 0;
-
-  double getDCN() const;
-
-  void setDCN(const std::vector<Individual> &survivors);
+  bool operator<(const Derived &ind) const { return fitness < ind.getFitness(); }
+};
 
-  virtual size_t getGenotypeLength() const = 0;
+template<class...>
+struct MakeVoid
+{
+  typedef void type;
+};
 
-  bool operator<(const Individual &ind) const;
+// True when T derives from Individual<T> and has every operator used by
+// GeneticAlgorithm<T> (stochasticLocalSearch returns the number of fitness
+// evaluations it ran):
+//   setSeed(uint64_t), initRandom(), setFitness(), mutate(double),
+//   cross(const T &, size_t), stochasticLocalSearch(size_t),
+//   getDistance(const T &), getGenotypeLength(), getStateSize(),
+//   saveState(uint8_t *), loadState(const uint8_t *).
+template<class T, class = void>
+struct IsIndividual : std::false_type
+{
+};
 
-  void stochasticLocalSearch(int n);
+template<class T>
+struct IsIndividual<T, typename MakeVoid<decltype(std::declval<T &>().setSeed(uint64_t())),
+                                         decltype(std::declval<T &>().initRandom()),
+                                         decltype(std::declval<T &>().setFitness()),
+                                         decltype(std::declval<T &>().mutate(double())),
+                                         decltype(std::declval<T &>().cross(std::declval<const T &>(), size_t())),
+                                         decltype(std::declval<T &>().stochasticLocalSearch(size_t())),
+                                         decltype(double(std::declval<const T &>().getDistance(std::declval<const T &>()))),
+                                         decltype(size_t(std::declval<const T &>().getGenotypeLength())),
+                                         decltype(size_t(std::declval<const T &>().getStateSize())),
+                                         decltype(std::declval<const T &>().saveState(std::declval<uint8_t *>())),
+                                         decltype(bool(std::declval<T &>().loadState(std::declval<const uint8_t *>())))>::type>
+    : std::is_base_of<Individual<T>, T>
+{
 };
 
-#endif // INDIVIDUAL_HPP
\ No newline at end of file
+#endif // INDIVIDUAL_HPP
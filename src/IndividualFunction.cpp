@@ -1,24 +1,98 @@
 #include "IndividualFunction.hpp"
 
 IndividualFunction::IndividualFunction(
-    double (*objetiveFunction)(std::vector<double>), double minDomainValue, double maxDomainValue, size_t bits, size_t dimensions)
+    double (*objetiveFunction)(const std::vector<double> &), double minDomainValue, double maxDomainValue, size_t bits, size_t dimensions)
     : objetiveFunction(objetiveFunction), minDomainValue(minDomainValue), maxDomainValue(maxDomainValue),
       step((maxDomainValue - minDomainValue) / (pow(2, bits) - 1)),
-      bits(bits), dimensions(dimensions), genotype(bits * dimensions),
-      randProbability(0, 100), randGen(0, 1)
-{    
+      bits(bits), dimensions(dimensions), length(bits * dimensions),
+      bitsInverse(UINT64_MAX / bits + 1), gray(false), genotype((length + 63) / 64, 0),
+      fenotype(dimensions), changed((dimensions + 63) / 64, 0), hash(0), hashValid(false)
+{
+    setAllChanged();
+}
+
+void IndividualFunction::setGrayCode(bool gray)
+{
+    this->gray = gray;
+    setAllChanged();
+}
+
+void IndividualFunction::setFitnessCache(std::shared_ptr<FitnessCache> cache)
+{
+    this->cache = cache;
 }
 
-std::vector<double> IndividualFunction::getFenotype()
+// Reads n <= 64 bits starting at pos, the first one as the least significant.
+uint64_t IndividualFunction::getBits(size_t pos, size_t n) const
 {
-    std::vector<double> fenotype(dimensions, 0);
-    for (size_t i = 0; i < dimensions; i++)
+    size_t word = pos / 64, offset = pos % 64;
+    uint64_t value = genotype[word] >> offset;
+    if (offset + n > 64)
     {
-        for (size_t j = 0; j < bits; j++)
+        value |= genotype[word + 1] << (64 - offset);
+    }
+    return n < 64 ? value & ((1ULL << n) - 1) : value;
+}
+
+void IndividualFunction::clearPadding()
+{
+    if (length % 64 != 0)
+    {
+        genotype.back() &= (1ULL << (length % 64)) - 1;
+    }
+}
+
+// A Gray code g is turned into binary by xoring all its right shifts.
+double IndividualFunction::decode(size_t i) const
+{
+    uint64_t value = getBits(i * bits, bits);
+    if (gray)
+    {
+        for (size_t shift = 1; shift < bits; shift *= 2)
         {
-            fenotype[i] += pow(2, j) * genotype[(i * bits) + j];
+            value ^= value >> shift;
         }
-        fenotype[i] = minDomainValue + fenotype[i] * step;
+    }
+    return minDomainValue + value * step;
+}
+
+// Variable holding bit pos. The division by bits is done as a product by
+// ceil(2^64 / bits), exact for positions below 2^32; it runs for every
+// mutated bit.
+size_t IndividualFunction::getVariable(size_t pos) const
+{
+    return bits == 1 ? pos : (size_t)(((unsigned __int128)pos * bitsInverse) >> 64);
+}
+
+void IndividualFunction::setChanged(size_t i)
+{
+    changed[i / 64] |= 1ULL << (i % 64);
+}
+
+void IndividualFunction::setAllChanged()
+{
+    std::fill(changed.begin(), changed.end(), ~0ULL);
+    if (dimensions % 64 != 0)
+    {
+        changed.back() = (1ULL << (dimensions % 64)) - 1;
+    }
+}
+
+bool IndividualFunction::isChanged(size_t i) const
+{
+    return (changed[i / 64] >> (i % 64)) & 1;
+}
+
+const std::vector<double> &IndividualFunction::getFenotype()
+{
+    for (size_t w = 0; w < changed.size(); w++)
+    {
+        for (uint64_t word = changed[w]; word != 0; word &= word - 1)
+        {
+            size_t i = w * 64 + __builtin_ctzll(word);
+            fenotype[i] = decode(i);
+        }
+        changed[w] = 0;
     }
     return fenotype;
 }
@@ -31,13 +105,12 @@ bool IndividualFunction::toFile(const char *filename)
         return false;
     }
     file << getFitness() << std::endl;
-    for (size_t i = 0; i < genotype.size(); i++)
+    for (size_t i = 0; i < length; i++)
     {
-        file << genotype[i] << " ";
+        file << getBit(i) << " ";
     }
     file << std::endl;
-    std::vector<double> fenotype = getFenotype();
-    for (auto f : fenotype)
+    for (auto f : getFenotype())
     {
         file << f << " ";
     }
@@ -46,45 +119,206 @@ bool IndividualFunction::toFile(const char *filename)
     return true;
 }
 
+void IndividualFunction::setSeed(uint64_t seed)
+{
+    gen.seed(seed);
+}
+
 void IndividualFunction::initRandom()
 {
-    std::random_device rd1;
-    gen.seed(rd1());
-    for (size_t i = 0; i < genotype.size(); i++)
+    for (auto &word : genotype)
     {
-        genotype[i] = randGen(gen);
+        word = gen();
     }
+    clearPadding();
+    setAllChanged();
+    hashValid = false;
     setFitness();
 }
 
+// Every bit flips with the given probability (a percentage). Instead of a
+// draw per bit, the gap to the next flipped bit is drawn from the geometric
+// distribution, so the cost grows with the number of flips.
 void IndividualFunction::mutate(const double probability)
 {
-    for (size_t i = 0; i < genotype.size(); i++)
+    double p = probability / 100;
+    if (p <= 0)
     {
-        if (randProbability(gen) < probability)
+        return;
+    }
+    if (p >= 1)
+    {
+        for (auto &word : genotype)
         {
-            genotype[i] = !genotype[i];
+            word = ~word;
         }
+        clearPadding();
+        setAllChanged();
+        hashValid = false;
+        dirty = true;
+        return;
+    }
+    double logQ = std::log1p(-p);
+    for (size_t i = 0;; i++)
+    {
+        double gap = std::floor(std::log(1 - gen.probability()) / logQ);
+        if (gap >= length - i)
+        {
+            return;
+        }
+        i += gap;
+        flip(i);
+    }
+}
+
+void IndividualFunction::flip(size_t i)
+{
+    uint64_t &word = genotype[i / 64];
+    if (hashValid)
+    {
+        hash ^= getWordHash(i / 64, word) ^ getWordHash(i / 64, word ^ (1ULL << (i % 64)));
     }
+    word ^= 1ULL << (i % 64);
+    setChanged(getVariable(i));
+    dirty = true;
 }
 
-void IndividualFunction::cross(const Individual &partner, const size_t pos)
+// Binary encoded continuous problems have no local search. A changed
+// individual is only scored, here rather than in calcFitness so that a cache
+// hit is not counted. Returns the number of times the objective function ran.
+size_t IndividualFunction::stochasticLocalSearch(size_t)
 {
-    const IndividualFunction &p = static_cast<const IndividualFunction &>(partner);
-    std::copy(std::next(p.getGenotype().begin(), pos), p.getGenotype().end(), std::next(genotype.begin(), pos));
+    return dirty ? computeFitness() : 0;
+}
+
+// Bits from pos onwards are taken from the partner: the word holding pos is
+// merged through a mask and the following ones are copied whole. The
+// variables after the one holding pos are taken from the partner's cache
+// when it is up to date.
+void IndividualFunction::cross(const IndividualFunction &p, size_t pos)
+{
+    size_t word = pos / 64;
+    uint64_t mask = ~0ULL << (pos % 64);
+    genotype[word] = (genotype[word] & ~mask) | (p.genotype[word] & mask);
+    dirty = true;
+    hashValid = false;
+    std::copy(p.genotype.begin() + word + 1, p.genotype.end(), genotype.begin() + word + 1);
+    size_t variable = getVariable(pos);
+    setChanged(variable);
+    for (size_t i = variable + 1; i < dimensions; i++)
+    {
+        if (p.isChanged(i))
+        {
+            setChanged(i);
+        }
+        else
+        {
+            fenotype[i] = p.fenotype[i];
+            changed[i / 64] &= ~(1ULL << (i % 64));
+        }
+    }
 }
 
 void IndividualFunction::setFitness()
 {
-    fitness = objetiveFunction(getFenotype());
+    computeFitness();
 }
 
-const std::vector<bool> &IndividualFunction::getGenotype() const
+// Returns whether the objective function ran, false when the fitness was
+// found in the cache.
+bool IndividualFunction::computeFitness()
+{
+    double cached;
+    if (cache && cache->find(getHash(), cached))
+    {
+        restoreFitness(cached);
+        return false;
+    }
+    restoreFitness(objetiveFunction(getFenotype()));
+    if (cache)
+    {
+        cache->insert(getHash(), fitness);
+    }
+    return true;
+}
+
+uint64_t IndividualFunction::getWordHash(size_t w, uint64_t word)
+{
+    return FitnessCache::mix(word ^ FitnessCache::mix(w + 1));
+}
+
+// Computed in full only after the genotype was rewritten; flip keeps it up
+// to date.
+uint64_t IndividualFunction::getHash()
+{
+    if (!hashValid)
+    {
+        hash = 0;
+        for (size_t w = 0; w < genotype.size(); w++)
+        {
+            hash ^= getWordHash(w, genotype[w]);
+        }
+        hashValid = true;
+    }
+    return hash;
+}
+
+size_t IndividualFunction::getGenotypeLength() const
+{
+    return length;
+}
+
+const std::vector<uint64_t> &IndividualFunction::getGenotype() const
 {
     return genotype;
 }
 
-bool IndividualFunction::operator<(const IndividualFunction &ind) const
+bool IndividualFunction::getBit(size_t i) const
+{
+    return (genotype[i / 64] >> (i % 64)) & 1;
+}
+
+// Hamming distance between the genotypes.
+double IndividualFunction::getDistance(const IndividualFunction &ind) const
+{
+    size_t distance = 0;
+    for (size_t i = 0; i < genotype.size(); i++)
+    {
+        distance += __builtin_popcountll(genotype[i] ^ ind.genotype[i]);
+    }
+    return distance;
+}
+
+size_t IndividualFunction::getStateSize() const
 {
-    return fitness < ind.getFitness();
-}
\ No newline at end of file
+    return sizeof(double) + 4 * sizeof(uint64_t) + genotype.size() * sizeof(uint64_t);
+}
+
+void IndividualFunction::saveState(uint8_t *state) const
+{
+    uint64_t random[4];
+    gen.getState(random);
+    std::memcpy(state, &fitness, sizeof(double));
+    std::memcpy(state + sizeof(double), random, sizeof random);
+    std::memcpy(state + sizeof(double) + sizeof random, genotype.data(), genotype.size() * sizeof(uint64_t));
+}
+
+// Rejects genotypes with bits set past the genotype length.
+bool IndividualFunction::loadState(const uint8_t *state)
+{
+    uint64_t last;
+    std::memcpy(&last, state + getStateSize() - sizeof(uint64_t), sizeof last);
+    if (length % 64 != 0 && (last >> (length % 64)) != 0)
+    {
+        return false;
+    }
+    uint64_t random[4];
+    std::memcpy(&fitness, state, sizeof(double));
+    std::memcpy(random, state + sizeof(double), sizeof random);
+    std::memcpy(genotype.data(), state + sizeof(double) + sizeof random, genotype.size() * sizeof(uint64_t));
+    gen.setState(random);
+    setAllChanged();
+    hashValid = false;
+    dirty = false;
+    return true;
+}
@@ -3,44 +3,92 @@
 
 #include <vector>
 #include <iterator>
-#include <random>
 #include <cstdlib>
+#include <cstdint>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <memory>
 
 #include "Individual.hpp"
+#include "Random.hpp"
+#include "FitnessCache.hpp"
 
-class IndividualFunction : public Individual
+// The genotype is packed 64 bits per word, bit i of the genotype being bit
+// i % 64 of word i / 64. Bits past the genotype length in the last word are
+// always zero, so whole words can be compared and counted. Variable i is
+// stored in bits [i * bits, (i + 1) * bits), in binary or in Gray code.
+//
+// The phenotype is cached: mutate and cross only mark the variables whose
+// bits they touched, and getFenotype decodes those again.
+//
+// With a fitness cache, setFitness looks the genotype up before running the
+// objective function. The genotype hash is the xor of a hash per word, so a
+// bit flip updates it in constant time.
+class IndividualFunction : public Individual<IndividualFunction>
 {
   private:
-    double (*objetiveFunction)(std::vector<double> x);
+    double (*objetiveFunction)(const std::vector<double> &x);
     double minDomainValue;
     double maxDomainValue;
     double step;
     size_t bits;
     size_t dimensions;
+    size_t length;
+    uint64_t bitsInverse;
 
-    std::vector<bool> genotype;
+    bool gray;
 
-    std::mt19937 gen;
-    std::uniform_real_distribution<> randProbability;
-    std::uniform_int_distribution<> randGen;
+    std::vector<uint64_t> genotype;
+    std::vector<double> fenotype;
+    std::vector<uint64_t> changed;
+
+    std::shared_ptr<FitnessCache> cache;
+    uint64_t hash;
+    bool hashValid;
+
+    Random gen;
+
+    uint64_t getBits(size_t pos, size_t n) const;
+    void clearPadding();
+    double decode(size_t i) const;
+    size_t getVariable(size_t pos) const;
+    void setChanged(size_t i);
+    void setAllChanged();
+    bool isChanged(size_t i) const;
+    void flip(size_t i);
+    static uint64_t getWordHash(size_t w, uint64_t word);
+    bool computeFitness();
 
   public:
     IndividualFunction() = default;
-    IndividualFunction(double (*objetiveFunction)(std::vector<double>), double minDomainValue, double maxDomainValue, size_t bits, size_t dimensions);
+    IndividualFunction(double (*objetiveFunction)(const std::vector<double> &), double minDomainValue, double maxDomainValue, size_t bits, size_t dimensions);
 
+    void setSeed(uint64_t seed);
+    void setGrayCode(bool gray);
+    // Individuals sharing a cache must share the objective function, domain,
+    // bits and coding.
+    void setFitnessCache(std::shared_ptr<FitnessCache> cache);
     void initRandom();
     void mutate(const double probability);
-    void cross(const Individual &partner, const size_t pos);
+    void cross(const IndividualFunction &partner, size_t pos);
+    size_t stochasticLocalSearch(size_t repetitions);
 
     void setFitness();
-    const std::vector<bool> &getGenotype() const;
-    std::vector<double> getFenotype();
+    size_t getGenotypeLength() const;
+    const std::vector<uint64_t> &getGenotype() const;
+    bool getBit(size_t i) const;
+    const std::vector<double> &getFenotype();
+    double getDistance(const IndividualFunction &ind) const;
+    uint64_t getHash();
 
-    bool toFile(const char* filename);
+    // Checkpoint record: fitness, generator state and genotype words.
+    size_t getStateSize() const;
+    void saveState(uint8_t *state) const;
+    bool loadState(const uint8_t *state);
 
-    bool operator<(const IndividualFunction &ind) const;
+    bool toFile(const char* filename);
 };
 
-#endif
\ No newline at end of file
+#endif
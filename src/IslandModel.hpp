@@ -0,0 +1,55 @@
+#ifndef ISLAND_MODEL_HPP
+#define ISLAND_MODEL_HPP
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "GeneticAlgorithm.hpp"
+
+// Runs several independent populations, one thread each, and exchanges their
+// best individuals every migrationInterval generations. Islands evolve in
+// epochs between migrations and a solution found by one island only stops the
+// others at the end of the epoch, so the exchanges and the generation count
+// are the same in every run with the same seed (as long as the time limit is
+// not reached).
+template<class T>
+class IslandModel
+{
+public:
+  enum Topology
+  {
+    Ring,
+    FullyConnected
+  };
+
+private:
+  size_t migrationInterval;
+  Topology topology;
+  std::vector<std::unique_ptr<GeneticAlgorithm<T>>> islands;
+  std::vector<T> migrants;
+  std::vector<int> generations;
+  std::atomic<bool> solved;
+
+  Random gen;
+
+  void evolveIsland(size_t k, std::chrono::steady_clock::time_point start, double maxSeconds);
+  void migrate();
+  template<class F>
+  void forEachIsland(F f);
+
+public:
+  IslandModel(const T &individual, size_t islandNumber, size_t populationSize, double mutationProbability, double crossoverProbability, size_t eliteNumber);
+  void setMigration(size_t interval, Topology topology);
+  void setSeed(uint64_t seed);
+  void initPoblation();
+  int run(double maxSeconds);
+  const T &getBest();
+};
+
+#include "IslandModel.tpp"
+
+#endif //ISLAND_MODEL_HPP
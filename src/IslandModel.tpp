@@ -0,0 +1,151 @@
+#include "IslandModel.hpp"
+
+template<class T>
+IslandModel<T>::IslandModel(
+    const T &individual, size_t islandNumber, size_t populationSize, double mutationProbability, double crossoverProbability, size_t eliteNumber)
+    : migrationInterval(10), topology(Ring), generations(islandNumber), solved(false), gen(Random::randomSeed())
+{
+    for (size_t k = 0; k < islandNumber; k++)
+    {
+        islands.emplace_back(new GeneticAlgorithm<T>(individual, populationSize, mutationProbability, crossoverProbability, eliteNumber));
+        islands.back()->setSeed(gen());
+    }
+}
+
+template<class T>
+void IslandModel<T>::setMigration(size_t interval, Topology topology)
+{
+    migrationInterval = interval;
+    this->topology = topology;
+}
+
+template<class T>
+void IslandModel<T>::setSeed(uint64_t seed)
+{
+    gen.seed(seed);
+    for (auto &island : islands)
+    {
+        island->setSeed(gen());
+    }
+}
+
+template<class T>
+template<class F>
+void IslandModel<T>::forEachIsland(F f)
+{
+    std::vector<std::thread> threads;
+    for (size_t k = 0; k < islands.size(); k++)
+    {
+        threads.emplace_back(f, k);
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+template<class T>
+void IslandModel<T>::initPoblation()
+{
+    for (auto &island : islands)
+    {
+        island->initPoblation();
+    }
+}
+
+// An island only stops early when it solves the puzzle itself or the time is
+// up, never because another island did, so the epoch does not depend on how
+// the threads were scheduled.
+template<class T>
+void IslandModel<T>::evolveIsland(size_t k, std::chrono::steady_clock::time_point start, double maxSeconds)
+{
+    double DI = 10;
+    for (size_t m = 0; m < migrationInterval; m++)
+    {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= maxSeconds)
+        {
+            return;
+        }
+        islands[k]->nextGeneration(DI - DI * elapsed / maxSeconds);
+        generations[k]++;
+        if (islands[k]->getBest().getFitness() == 0)
+        {
+            solved = true;
+            return;
+        }
+    }
+}
+
+template<class T>
+void IslandModel<T>::migrate()
+{
+    migrants.clear();
+    for (auto &island : islands)
+    {
+        migrants.push_back(island->getBest());
+    }
+    for (size_t k = 0; k < islands.size(); k++)
+    {
+        if (topology == Ring)
+        {
+            islands[(k + 1) % islands.size()]->immigrate(migrants[k]);
+            continue;
+        }
+        for (size_t j = 0; j < islands.size(); j++)
+        {
+            if (j != k)
+            {
+                islands[j]->immigrate(migrants[k]);
+            }
+        }
+    }
+}
+
+// Returns the generations of the island that found the solution, the fewest
+// if several did in the same epoch, or of the longest running island.
+template<class T>
+int IslandModel<T>::run(double maxSeconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    solved = false;
+    std::fill(generations.begin(), generations.end(), 0);
+    forEachIsland([this](size_t k) {
+        islands[k]->improvePopulation();
+        if (islands[k]->getBest().getFitness() == 0)
+        {
+            solved = true;
+        }
+    });
+    while (!solved && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < maxSeconds)
+    {
+        forEachIsland([this, start, maxSeconds](size_t k) { evolveIsland(k, start, maxSeconds); });
+        if (!solved)
+        {
+            migrate();
+        }
+    }
+    int result = *std::max_element(generations.begin(), generations.end());
+    for (size_t k = 0; k < islands.size(); k++)
+    {
+        if (islands[k]->getBest().getFitness() == 0)
+        {
+            result = std::min(result, generations[k]);
+        }
+    }
+    return result;
+}
+
+template<class T>
+const T &IslandModel<T>::getBest()
+{
+    size_t best = 0;
+    for (size_t k = 1; k < islands.size(); k++)
+    {
+        if (islands[k]->getBest() < islands[best]->getBest())
+        {
+            best = k;
+        }
+    }
+    return islands[best]->getBest();
+}
@@ -0,0 +1,59 @@
+#include "MappedFile.hpp"
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile() : address(nullptr), length(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cout << "No se pudo abrir el archivo: " << filename << std::endl;
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        std::cout << "No se pudo leer el archivo: " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (status.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            std::cout << "No se pudo leer el archivo: " << filename << std::endl;
+            ::close(fd);
+            return false;
+        }
+        address = static_cast<const uint8_t *>(mapping);
+        length = status.st_size;
+    }
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(address), length);
+    }
+    address = nullptr;
+    length = 0;
+}
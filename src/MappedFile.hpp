@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. The mapping is released when the
+// object is destroyed or another file is opened.
+class MappedFile
+{
+private:
+  const uint8_t *address;
+  size_t length;
+
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const std::string &filename);
+  void close();
+
+  const uint8_t *data() const { return address; }
+  size_t size() const { return length; }
+};
+
+#endif // MAPPED_FILE_HPP
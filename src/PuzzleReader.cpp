@@ -0,0 +1,219 @@
+#include "PuzzleReader.hpp"
+
+namespace
+{
+const char *endOfLine(const char *first, const char *last)
+{
+    while (first != last && *first != '\n')
+    {
+        first++;
+    }
+    return first;
+}
+
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+size_t getStep(size_t size)
+{
+    size_t step = 1;
+    while (step * step < size)
+    {
+        step++;
+    }
+    return step;
+}
+}
+
+bool PuzzleReader::readFile(const std::string &filename, std::vector<Puzzle> &puzzles)
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        return false;
+    }
+    return read(filename, reinterpret_cast<const char *>(file.data()), file.size(), puzzles);
+}
+
+bool PuzzleReader::read(const std::string &name, const char *data, size_t size, std::vector<Puzzle> &puzzles)
+{
+    this->name = name;
+    const char *first = data, *last = data + size;
+    while (first != last)
+    {
+        const char *end = endOfLine(first, last);
+        const char *c = first, *stop = end;
+        while (c != stop && isBlank(*c))
+        {
+            c++;
+        }
+        while (stop != c && isBlank(stop[-1]))
+        {
+            stop--;
+        }
+        if (c != stop && *c != '#')
+        {
+            bool grid = std::find_if(c, stop, isBlank) != stop;
+            return grid ? parseGrid(data, last, puzzles) : parseLines(data, last, puzzles);
+        }
+        first = end == last ? end : end + 1;
+    }
+    return fail(1, "no hay ningun sudoku");
+}
+
+bool PuzzleReader::fail(size_t line, const std::string &message) const
+{
+    std::cout << "Formato invalido: " << name << ":" << line << ": " << message << std::endl;
+    return false;
+}
+
+bool PuzzleReader::parseGrid(const char *first, const char *last, std::vector<Puzzle> &puzzles) const
+{
+    std::vector<uint8_t> cells;
+    size_t rows = 0, columns = 0, line = 1, firstLine = 0;
+    for (; first != last; line++)
+    {
+        const char *end = endOfLine(first, last);
+        size_t count = 0;
+        for (const char *c = first; c != end;)
+        {
+            if (isBlank(*c))
+            {
+                c++;
+                continue;
+            }
+            if (*c < '0' || *c > '9')
+            {
+                return fail(line, std::string("caracter inesperado '") + *c + "'");
+            }
+            unsigned value = 0;
+            for (; c != end && *c >= '0' && *c <= '9'; c++)
+            {
+                value = value * 10 + (*c - '0');
+                if (value > 255)
+                {
+                    return fail(line, "valor fuera de rango");
+                }
+            }
+            cells.push_back(value);
+            count++;
+        }
+        if (count > 0)
+        {
+            if (rows == 0)
+            {
+                columns = count;
+                firstLine = line;
+            }
+            else if (count != columns)
+            {
+                return fail(line, "se esperaban " + std::to_string(columns) + " valores y hay " + std::to_string(count));
+            }
+            rows++;
+        }
+        first = end == last ? end : end + 1;
+    }
+    if (rows != columns)
+    {
+        return fail(line - 1, "el tablero tiene " + std::to_string(rows) + " filas y " + std::to_string(columns) + " columnas");
+    }
+    Puzzle puzzle = {Board(rows), firstLine};
+    std::copy(cells.begin(), cells.end(), puzzle.board.data());
+    if (!validate(puzzle.board, firstLine))
+    {
+        return false;
+    }
+    puzzles.push_back(std::move(puzzle));
+    return true;
+}
+
+bool PuzzleReader::parseLines(const char *first, const char *last, std::vector<Puzzle> &puzzles) const
+{
+    for (size_t line = 1; first != last; line++)
+    {
+        const char *end = endOfLine(first, last);
+        const char *stop = end;
+        while (stop != first && isBlank(stop[-1]))
+        {
+            stop--;
+        }
+        size_t length = stop - first;
+        if (length > 0 && *first != '#')
+        {
+            size_t size = getStep(length);
+            if (size * size != length)
+            {
+                return fail(line, "la linea tiene " + std::to_string(length) + " caracteres");
+            }
+            Puzzle puzzle = {Board(size), line};
+            uint8_t *cell = puzzle.board.data();
+            for (const char *c = first; c != stop; c++, cell++)
+            {
+                if (*c == '.' || *c == '0')
+                {
+                    *cell = 0;
+                }
+                else if (*c >= '1' && *c <= '9')
+                {
+                    *cell = *c - '0';
+                }
+                else if (*c >= 'A' && *c <= 'Z')
+                {
+                    *cell = *c - 'A' + 10;
+                }
+                else if (*c >= 'a' && *c <= 'z')
+                {
+                    *cell = *c - 'a' + 10;
+                }
+                else
+                {
+                    return fail(line, std::string("caracter inesperado '") + *c + "'");
+                }
+            }
+            if (!validate(puzzle.board, line))
+            {
+                return false;
+            }
+            puzzles.push_back(std::move(puzzle));
+        }
+        first = end == last ? end : end + 1;
+    }
+    return true;
+}
+
+bool PuzzleReader::validate(const Board &board, size_t line) const
+{
+    const size_t size = board.getSize(), step = getStep(size);
+    if (step * step != size || size < 4 || size > 31)
+    {
+        return fail(line, "tamano no valido: " + std::to_string(size));
+    }
+    std::vector<uint32_t> rows(size, 0), cols(size, 0), blocks(size, 0);
+    for (size_t i = 0; i < size; i++)
+    {
+        for (size_t j = 0; j < size; j++)
+        {
+            uint8_t value = board(i, j);
+            if (value > size)
+            {
+                return fail(line, "valor fuera de rango: " + std::to_string(value));
+            }
+            if (value == 0)
+            {
+                continue;
+            }
+            uint32_t bit = 1u << value;
+            size_t block = i / step * step + j / step;
+            if ((rows[i] | cols[j] | blocks[block]) & bit)
+            {
+                return fail(line, "pista repetida en la fila " + std::to_string(i + 1) + ", columna " + std::to_string(j + 1));
+            }
+            rows[i] |= bit;
+            cols[j] |= bit;
+            blocks[block] |= bit;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef PUZZLE_READER_HPP
+#define PUZZLE_READER_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+#include <iostream>
+
+#include "Grid.hpp"
+#include "MappedFile.hpp"
+
+// Parses puzzles straight from memory into flat boards; files are mapped and
+// read in place. Two formats are accepted and told apart by the first line:
+// - grid: one puzzle, a row per line with the cells separated by spaces and
+//   0 for an empty cell (the format of data/);
+// - line: one puzzle per line with one character per cell, '.' or '0' for an
+//   empty cell and letters for digits above 9 (A = 10). Lines starting with
+//   '#' are skipped.
+// Every board is checked for shape, digit range and repeated clues. Errors
+// are printed with the line where they were found.
+class PuzzleReader
+{
+public:
+  struct Puzzle
+  {
+    Board board;
+    size_t line;
+  };
+
+private:
+  std::string name;
+
+  bool fail(size_t line, const std::string &message) const;
+  bool validate(const Board &board, size_t line) const;
+  bool parseGrid(const char *first, const char *last, std::vector<Puzzle> &puzzles) const;
+  bool parseLines(const char *first, const char *last, std::vector<Puzzle> &puzzles) const;
+
+public:
+  bool readFile(const std::string &filename, std::vector<Puzzle> &puzzles);
+  bool read(const std::string &name, const char *data, size_t size, std::vector<Puzzle> &puzzles);
+};
+
+#endif // PUZZLE_READER_HPP
@@ -0,0 +1,132 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <random>
+
+// xoshiro256** generator. Seeding only runs splitmix64, so every individual
+// can get its own stream cheaply: Random(seed, stream) gives independent
+// sequences for different stream numbers, and jump() advances 2^128 steps.
+// Bounded integers and shuffles are computed here rather than with the
+// standard distributions so a seed gives the same run with any library.
+class Random
+{
+private:
+  uint64_t s[4];
+
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  static uint64_t splitmix64(uint64_t &x)
+  {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+public:
+  typedef uint64_t result_type;
+
+  Random(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  static uint64_t randomSeed()
+  {
+    std::random_device rd;
+    return (uint64_t(rd()) << 32) | rd();
+  }
+
+  void seed(uint64_t seed, uint64_t stream = 0)
+  {
+    uint64_t x = seed ^ splitmix64(stream);
+    for (auto &word : s)
+    {
+      word = splitmix64(x);
+    }
+  }
+
+  result_type operator()()
+  {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+  }
+
+  void getState(uint64_t state[4]) const
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      state[i] = s[i];
+    }
+  }
+
+  void setState(const uint64_t state[4])
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      s[i] = state[i];
+    }
+  }
+
+  void jump()
+  {
+    static const uint64_t polynomial[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t t[4] = {0, 0, 0, 0};
+    for (auto word : polynomial)
+    {
+      for (int b = 0; b < 64; b++)
+      {
+        if (word & (1ULL << b))
+        {
+          for (int i = 0; i < 4; i++)
+          {
+            t[i] ^= s[i];
+          }
+        }
+        (*this)();
+      }
+    }
+    for (int i = 0; i < 4; i++)
+    {
+      s[i] = t[i];
+    }
+  }
+
+  // Uniform integer in [0, n).
+  size_t below(size_t n)
+  {
+    return (size_t)(((unsigned __int128)(*this)() * n) >> 64);
+  }
+
+  // Uniform real in [0, 1).
+  double probability()
+  {
+    return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  double uniform(double a, double b)
+  {
+    return a + (b - a) * probability();
+  }
+
+  template<class It>
+  void shuffle(It first, It last)
+  {
+    for (size_t n = last - first; n > 1; n--)
+    {
+      std::swap(first[n - 1], first[below(n)]);
+    }
+  }
+};
+
+#endif // RANDOM_HPP
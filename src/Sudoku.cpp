@@ -1,101 +1,52 @@
 #include "Sudoku.hpp"
 
-Sudoku::Sudoku(std::string filename)
+template<size_t B>
+BasicSudoku<B>::BasicSudoku(std::string filename) : BasicSudoku(std::make_shared<const SudokuInstance>(filename))
 {
-    readFromFile(filename);
-    step = sqrt(original.size());
-    initMissingNumbersTable();
-    setFreeCells();
 }
 
-void Sudoku::setPermutationsPerBlock()
+// An instance that is not valid or has another size is rejected: the board
+// stays empty, no instance is kept and isValid returns false.
+template<size_t B>
+BasicSudoku<B>::BasicSudoku(std::shared_ptr<const SudokuInstance> instance)
 {
-    permutationsPerBlock.resize(original.size());
-    for (size_t i = 0; i < permutationsPerBlock.size(); i++)
+    solution.fill(0);
+    if (!instance || !instance->isValid() || instance->getSize() != sudokuSize)
     {
-        std::vector<unsigned short> options = missingNumbersTable[i];
-        do
-        {
-            permutationsPerBlock[i].push_back(options);
-        } while (std::next_permutation(options.begin(), options.end()));
-    }
-}
-
-void Sudoku::initMissingNumbersTable()
-{
-    missingNumbersTable.resize(original.size());
-    for (size_t k = 0; k < original.size(); k += step)
-    {
-        for (size_t l = 0; l < original.size(); l += step)
-        {
-            missingNumbersTable[l / step + k] = getMissingElementsSquare(k, l);
-        }
+        std::cout << "Instancia no valida para un sudoku de " << sudokuSize << "x" << sudokuSize << std::endl;
+        return;
     }
+    solution = instance->getOriginal();
+    this->instance = instance;
 }
 
-void Sudoku::setFreeCells()
+template<size_t B>
+bool BasicSudoku<B>::isValid() const
 {
-    tableFreeCells.resize(original.size());
-    for (size_t k = 0; k < original.size(); k += step)
-    {
-        for (size_t l = 0; l < original.size(); l += step)
-        {
-            unsigned short cell = 0;
-            for (size_t i = k; i < k + step; i++)
-            {
-                for (size_t j = l; j < l + step; j++, cell++)
-                {
-                    if (original[i][j] == 0)
-                    {
-                        tableFreeCells[l / step + k].push_back(cell);
-                    }
-                }
-            }
-        }
-    }
+    return instance != nullptr;
 }
 
-void Sudoku::setSquare(std::vector<unsigned short> &values, size_t k, size_t l)
+template<size_t B>
+void BasicSudoku<B>::setSquare(const uint8_t *values, size_t k, size_t l)
 {
+    const Board &original = instance->getOriginal();
     size_t pos = 0;
+    dirty = true;
     for (size_t i = k; i < k + step; i++)
     {
         for (size_t j = l; j < l + step; j++)
         {
-            if (original[i][j] == 0)
+            if (original(i, j) == 0)
             {
-                solution[i][j] = values[pos];
+                solution(i, j) = values[pos];
                 pos++;
             }
         }
     }
 }
 
-bool Sudoku::readFromFile(std::string filename)
-{
-    std::ifstream file(filename);
-    if (!file.is_open())
-    {
-        std::cout << "No se pudo abrir el archivo: " << filename << std::endl;
-        return false;
-    }
-    std::string line;
-    while (std::getline(file, line))
-    {
-        std::vector<unsigned short> row;
-        std::istringstream iss(line);
-        std::string s;
-        while (std::getline(iss, s, ' '))
-        {
-            row.push_back(std::stoul(s));
-        }
-        original.push_back(row);
-    }
-    file.close();
-    return true;
-}
-
-void Sudoku::createSolution(bool useRandom)
+template<size_t B>
+void BasicSudoku<B>::createSolution(bool useRandom)
 {
     if (useRandom)
     {
@@ -107,132 +58,148 @@ void Sudoku::createSolution(bool useRandom)
     }
 }
 
-void Sudoku::createRandomSolution()
+template<size_t B>
+void BasicSudoku<B>::createRandomSolution()
 {
-    solution = original;
-    for (size_t k = 0; k < solution.size(); k += step)
+    Assignment assignment;
+    solution = instance->getOriginal();
+    dirty = true;
+    for (size_t k = 0; k < sudokuSize; k += step)
     {
-        for (size_t l = 0; l < solution.size(); l += step)
+        for (size_t l = 0; l < sudokuSize; l += step)
         {
-            createRandomSquare(k, l);
+            createRandomSquare(k, l, assignment);
         }
     }
 }
 
-void Sudoku::createRandomSquare(int k, int l)
-{
-    std::vector<unsigned short> options = getSuffledMissingElementsSquare(k, l);
-    for (size_t i = k; i < k + step; i++)
+// Fills the free cells of the block with a random assignment of its missing
+// digits in which every cell gets one of its presolved candidates: the
+// Hungarian assignment over random costs, with a non-candidate digit costing
+// more than any sum of them, so it is only used when no such assignment
+// exists. The swaps that keep the candidates start from a consistent block.
+template<size_t B>
+void BasicSudoku<B>::createRandomSquare(size_t k, size_t l, Assignment &assignment)
+{
+    const std::vector<unsigned short> &freeCells = instance->getFreeCells(l / step + k);
+    const int excludedCost = sudokuSize * sudokuSize;
+    UnitValues options, values;
+    size_t n = getSuffledMissingElementsSquare(k, l, options);
+    assignment.resize(n);
+    for (size_t c = 0; c < n; c++)
     {
-        for (size_t j = l; j < l + step; j++)
+        size_t i = k + freeCells[c] / step, j = l + freeCells[c] % step;
+        for (size_t o = 0; o < n; o++)
         {
-            if (original[i][j] == 0)
-            {
-                solution[i][j] = options.back();
-                options.pop_back();
-            }
+            assignment.cost(c, o) = instance->isCandidate(i, j, options[o]) ? (int)gen.below(sudokuSize) : excludedCost;
         }
     }
+    assignment.solve();
+    for (size_t c = 0; c < n; c++)
+    {
+        values[c] = options[assignment.getColumn(c)];
+    }
+    setSquare(values.data(), k, l);
 }
 
-void Sudoku::createConstructiveHeuristicSolution()
+template<size_t B>
+void BasicSudoku<B>::createConstructiveHeuristicSolution()
 {
-    solution = original;
-    for (size_t k = 0; k < solution.size(); k += step)
+    solution = instance->getOriginal();
+    dirty = true;
+    for (size_t k = 0; k < sudokuSize; k += step)
     {
-        for (size_t l = 0; l < solution.size(); l += step)
+        for (size_t l = 0; l < sudokuSize; l += step)
         {
             createConstructiveHeuristicSquare(k, l);
         }
     }
 }
 
-void Sudoku::createConstructiveHeuristicSquare(int k, int l)
+template<size_t B>
+void BasicSudoku<B>::createConstructiveHeuristicSquare(int k, int l)
 {
-    std::vector<unsigned short> options = getSuffledMissingElementsSquare(k, l);
+    const Board &original = instance->getOriginal();
+    UnitValues options;
+    size_t n = getSuffledMissingElementsSquare(k, l, options);
     for (size_t i = k; i < k + step; i++)
     {
         for (size_t j = l; j < l + step; j++)
         {
-            if (original[i][j] == 0)
+            if (original(i, j) == 0)
             {
-                for (auto option : options)
+                Mask used = 0;
+                for (size_t t = 0; t < sudokuSize; t++)
+                {
+                    used |= Mask(1) << solution(i, t);
+                }
+                for (size_t o = 0; o < n; o++)
                 {
-                    if (std::find(solution[i].begin(), solution[i].end(), option) == solution[i].end())
+                    if (instance->isCandidate(i, j, options[o]) && !(used & (Mask(1) << options[o])))
                     {
-                        solution[i][j] = option;
-                        options.erase(std::find(options.begin(), options.end(), option));
+                        solution(i, j) = options[o];
+                        std::copy(options.begin() + o + 1, options.begin() + n--, options.begin() + o);
                         break;
                     }
                 }
-                if (solution[i][j] == 0)
+                if (solution(i, j) == 0)
                 {
-                    solution[i][j] = options.back();
-                    options.pop_back();
+                    solution(i, j) = options[--n];
                 }
             }
         }
     }
 }
 
-std::vector<unsigned short> Sudoku::getMissingElementsSquare(size_t k, size_t l)
+template<size_t B>
+size_t BasicSudoku<B>::getSuffledMissingElementsSquare(size_t k, size_t l, UnitValues &options)
 {
-    std::vector<unsigned short> options(original.size());
-    std::iota(options.begin(), options.end(), 1);
-    for (size_t i = k; i < k + step; i++)
-    {
-        for (size_t j = l; j < l + step; j++)
-        {
-            if (original[i][j] != 0)
-            {
-                options.erase(std::find(options.begin(), options.end(), original[i][j]));
-            }
-        }
-    }
-    return options;
+    const std::vector<unsigned short> &missing = instance->getMissingNumbers(l / step + k);
+    std::copy(missing.begin(), missing.end(), options.begin());
+    gen.shuffle(options.begin(), options.begin() + missing.size());
+    return missing.size();
 }
 
-std::vector<unsigned short> Sudoku::getSuffledMissingElementsSquare(size_t k, size_t l)
+template<size_t B>
+void BasicSudoku<B>::print(const uint8_t *board)
 {
-    std::vector<unsigned short> options = getMissingElementsSquare(k, l);
-    std::random_shuffle(options.begin(), options.end());
-    return options;
-}
-
-void Sudoku::print(std::vector<std::vector<unsigned short>> &board)
-{
-    for (auto &row : board)
+    for (size_t i = 0; i < sudokuSize; i++)
     {
-        for (auto i : row)
+        for (size_t j = 0; j < sudokuSize; j++)
         {
-            std::cout << i << " ";
+            std::cout << (int)board[i * sudokuSize + j] << " ";
         }
         std::cout << std::endl;
     }
     std::cout << std::endl;
 }
 
-void Sudoku::printSolution()
+template<size_t B>
+void BasicSudoku<B>::printSolution()
 {
-    print(solution);
+    print(solution.data());
 }
 
-void Sudoku::printOriginal()
+template<size_t B>
+void BasicSudoku<B>::printOriginal()
 {
-    print(original);
+    print(instance->getOriginal().data());
 }
 
-const std::vector<std::vector<unsigned short>> &Sudoku::getSolution() const
+template<size_t B>
+const typename BasicSudoku<B>::SolutionBoard &BasicSudoku<B>::getSolution() const
 {
     return solution;
 }
 
-int Sudoku::getConflicts()
+template<size_t B>
+int BasicSudoku<B>::getConflicts()
 {
     return getConflictsRowsAndCols();
 }
 
-int Sudoku::getConflicts(std::vector<int> &hist)
+template<size_t B>
+int BasicSudoku<B>::getConflicts(const std::array<int, sudokuSize> &hist) const
 {
     int conflicts = 0;
     for (auto i : hist)
@@ -242,29 +209,31 @@ int Sudoku::getConflicts(std::vector<int> &hist)
     return conflicts;
 }
 
-int Sudoku::getConflicts(unsigned short value, size_t k, size_t l)
+template<size_t B>
+int BasicSudoku<B>::getConflicts(unsigned short value, size_t k, size_t l) const
 {
+    const Board &original = instance->getOriginal();
     int conflicts = 0;
-    for (size_t i = 0; i < solution.size(); i++)
+    for (size_t i = 0; i < sudokuSize; i++)
     {
         if (l != i)
         {
-            if (value == original[k][i])
+            if (value == original(k, i))
             {
                 conflicts += weightOriginalConflict;
             }
-            else if (value == solution[k][i])
+            else if (value == solution(k, i))
             {
                 conflicts++;
             }
         }
         if (k != i)
         {
-            if (value == original[i][l])
+            if (value == original(i, l))
             {
                 conflicts += weightOriginalConflict;
             }
-            else if (value == solution[i][l])
+            else if (value == solution(i, l))
             {
                 conflicts++;
             }
@@ -273,21 +242,25 @@ int Sudoku::getConflicts(unsigned short value, size_t k, size_t l)
     return conflicts;
 }
 
-int Sudoku::getConflictsRows()
+template<size_t B>
+int BasicSudoku<B>::getConflictsRows() const
 {
+    const Board &original = instance->getOriginal();
     int conflicts = 0;
-    for (size_t i = 0; i < solution.size(); i++)
+    for (size_t i = 0; i < sudokuSize; i++)
     {
-        std::vector<int> hist(solution.size(), -1);
-        for (size_t j = 0; j < solution[i].size(); j++)
+        std::array<int, sudokuSize> hist;
+        hist.fill(-1);
+        const uint8_t *row = solution.row(i), *clues = original.row(i);
+        for (size_t j = 0; j < sudokuSize; j++)
         {
-            if (original[i][j] != 0 && hist[original[i][j] - 1] != -1)
+            if (clues[j] != 0 && hist[clues[j] - 1] != -1)
             {
-                hist[original[i][j] - 1] += weightOriginalConflict;
+                hist[clues[j] - 1] += weightOriginalConflict;
             }
             else
             {
-                hist[solution[i][j] - 1]++;
+                hist[row[j] - 1]++;
             }
         }
         conflicts += getConflicts(hist);
@@ -295,21 +268,25 @@ int Sudoku::getConflictsRows()
     return conflicts;
 }
 
-int Sudoku::getConflictsCols()
+template<size_t B>
+int BasicSudoku<B>::getConflictsCols() const
 {
+    const Board &original = instance->getOriginal();
     int conflicts = 0;
-    for (size_t i = 0; i < solution.size(); i++)
+    for (size_t i = 0; i < sudokuSize; i++)
     {
-        std::vector<int> hist(solution.size(), -1);
-        for (size_t j = 0; j < solution[i].size(); j++)
+        std::array<int, sudokuSize> hist;
+        hist.fill(-1);
+        StridedView<const uint8_t> col = solution.col(i), clues = original.col(i);
+        for (size_t j = 0; j < sudokuSize; j++)
         {
-            if (original[j][i] != 0 && hist[original[j][i] - 1] != -1)
+            if (clues[j] != 0 && hist[clues[j] - 1] != -1)
             {
-                hist[original[j][i] - 1] += weightOriginalConflict;
+                hist[clues[j] - 1] += weightOriginalConflict;
             }
             else
             {
-                hist[solution[j][i] - 1]++;
+                hist[col[j] - 1]++;
             }
         }
         conflicts += getConflicts(hist);
@@ -317,132 +294,199 @@ int Sudoku::getConflictsCols()
     return conflicts;
 }
 
-int Sudoku::getConflictsRowsAndCols()
+template<size_t B>
+int BasicSudoku<B>::getConflictsRowsAndCols() const
+{
+    return kernels::rowColumnConflicts(solution.data(), sudokuSize, instance->getRowClueMask(), instance->getColClueMask(), weightOriginalConflict);
+}
+
+template<size_t B>
+int BasicSudoku<B>::getConflictsSquare() const
 {
+    const Board &original = instance->getOriginal();
     int conflicts = 0;
-    for (size_t i = 0; i < solution.size(); i++)
+    for (size_t k = 0; k < sudokuSize; k += step)
     {
-        std::vector<int> hist1(solution.size(), -1);
-        std::vector<int> hist2(solution.size(), -1);
-        for (size_t j = 0; j < solution[i].size(); j++)
+        for (size_t l = 0; l < sudokuSize; l += step)
         {
-            hist1[solution[j][i] - 1]++;
-            hist2[solution[i][j] - 1]++;
-        }
-
-        for (size_t j = 0; j < solution[i].size(); j++)
-        {
-            if (original[j][i] != 0 && hist1[original[j][i] - 1] > 0)
+            std::array<int, sudokuSize> hist;
+            hist.fill(-1);
+            BlockView<const uint8_t> block = solution.block(k, l, step), clues = original.block(k, l, step);
+            for (size_t cell = 0; cell < sudokuSize; cell++)
             {
-                hist1[original[j][i] - 1] += weightOriginalConflict;
-            }
-            if (original[i][j] != 0 && hist2[original[i][j] - 1] > 0)
-            {
-                hist2[original[i][j] - 1] += weightOriginalConflict;
+                if (clues[cell] != 0 && hist[clues[cell] - 1] != -1)
+                {
+                    hist[clues[cell] - 1] += weightOriginalConflict;
+                }
+                else
+                {
+                    hist[block[cell] - 1]++;
+                }
             }
+            conflicts += getConflicts(hist);
         }
-        conflicts += getConflicts(hist1);
-        conflicts += getConflicts(hist2);
     }
     return conflicts;
 }
 
-int Sudoku::getConflictsSquare()
+template<size_t B>
+int BasicSudoku<B>::getUnitConflicts(unsigned short count, unsigned short clues) const
 {
-    int conflicts = 0;
-    for (size_t k = 0; k < solution.size(); k += step)
+    if (count == 0)
+    {
+        return 1;
+    }
+    return count > 1 ? count - 1 + weightOriginalConflict * clues : 0;
+}
+
+template<size_t B>
+int BasicSudoku<B>::getUnitDelta(const unsigned short *count, const unsigned short *clues,
+                         unsigned short removed, unsigned short added) const
+{
+    return getUnitConflicts(count[removed - 1] - 1, clues[removed - 1]) - getUnitConflicts(count[removed - 1], clues[removed - 1]) +
+           getUnitConflicts(count[added - 1] + 1, clues[added - 1]) - getUnitConflicts(count[added - 1], clues[added - 1]);
+}
+
+template<size_t B>
+int BasicSudoku<B>::initConflictCounters()
+{
+    rowCount.fill(0);
+    colCount.fill(0);
+    for (size_t i = 0; i < sudokuSize; i++)
     {
-        for (size_t l = 0; l < solution.size(); l += step)
+        for (size_t j = 0; j < sudokuSize; j++)
         {
-            std::vector<int> hist(solution.size(), -1);
-            for (size_t i = k; i < step + k; i++)
-            {
-                for (size_t j = l; j < step + l; j++)
-                {
-                    if (original[i][j] != 0 && hist[original[i][j] - 1] != -1)
-                    {
-                        hist[original[i][j] - 1] += weightOriginalConflict;
-                    }
-                    else
-                    {
-                        hist[solution[i][j] - 1]++;
-                    }
-                }
-            }
-            conflicts += getConflicts(hist);
+            rowCount(i, solution(i, j) - 1)++;
+            colCount(j, solution(i, j) - 1)++;
         }
     }
-    return conflicts;
+    currentConflicts = 0;
+    for (size_t i = 0; i < sudokuSize; i++)
+    {
+        for (size_t d = 0; d < sudokuSize; d++)
+        {
+            currentConflicts += getUnitConflicts(rowCount(i, d), instance->getRowClues()(i, d));
+            currentConflicts += getUnitConflicts(colCount(i, d), instance->getColClues()(i, d));
+        }
+    }
+    return currentConflicts;
 }
 
-size_t Sudoku::stochasticLocalSearch(size_t repetitions)
+// A swap may not move a value into a cell whose presolved candidates exclude it.
+template<size_t B>
+bool BasicSudoku<B>::isSwapAllowed(size_t i1, size_t j1, size_t i2, size_t j2) const
+{
+    return instance->isCandidate(i1, j1, solution(i2, j2)) && instance->isCandidate(i2, j2, solution(i1, j1));
+}
+
+template<size_t B>
+int BasicSudoku<B>::getSwapDelta(size_t i1, size_t j1, size_t i2, size_t j2) const
+{
+    unsigned short a = solution(i1, j1), b = solution(i2, j2);
+    if (a == b)
+    {
+        return 0;
+    }
+    int delta = 0;
+    if (i1 != i2)
+    {
+        delta += getUnitDelta(rowCount.row(i1), instance->getRowClues().row(i1), a, b);
+        delta += getUnitDelta(rowCount.row(i2), instance->getRowClues().row(i2), b, a);
+    }
+    if (j1 != j2)
+    {
+        delta += getUnitDelta(colCount.row(j1), instance->getColClues().row(j1), a, b);
+        delta += getUnitDelta(colCount.row(j2), instance->getColClues().row(j2), b, a);
+    }
+    return delta;
+}
+
+template<size_t B>
+void BasicSudoku<B>::applySwap(size_t i1, size_t j1, size_t i2, size_t j2)
+{
+    unsigned short a = solution(i1, j1), b = solution(i2, j2);
+    currentConflicts += getSwapDelta(i1, j1, i2, j2);
+    rowCount(i1, a - 1)--;
+    rowCount(i1, b - 1)++;
+    rowCount(i2, b - 1)--;
+    rowCount(i2, a - 1)++;
+    colCount(j1, a - 1)--;
+    colCount(j1, b - 1)++;
+    colCount(j2, b - 1)--;
+    colCount(j2, a - 1)++;
+    std::swap(solution(i1, j1), solution(i2, j2));
+    dirty = true;
+}
+
+// Returns the number of fitness evaluations: the conflicts are counted once
+// and every swap is then scored by its delta.
+template<size_t B>
+size_t BasicSudoku<B>::stochasticLocalSearch(size_t repetitions)
 {
     int iTolerance = 0, tolerance = repetitions * .20;
     int lastConflicts, conflicts;
-    lastConflicts = conflicts = getConflicts();
+    lastConflicts = conflicts = initConflictCounters();
     for (size_t i = 0; i < repetitions; i++)
     {
-        std::vector<bool> improveSquare(solution.size());
+        Mask improveSquare = 0;
         size_t square = 0;
-        for (size_t k = 0; k < solution.size(); k += step)
+        for (size_t k = 0; k < sudokuSize; k += step)
         {
-            for (size_t l = 0; l < solution.size(); l += step, square++)
+            for (size_t l = 0; l < sudokuSize; l += step, square++)
             {
-                improveSquare[square] = stochasticLocalSearchSquare(k, l, step);
+                improveSquare |= Mask(stochasticLocalSearchSquare(k, l)) << square;
             }
         }
-        if (find(improveSquare.begin(), improveSquare.end(), true) == improveSquare.end())
+        if (improveSquare == 0)
         {
-            return i;
+            restoreFitness(currentConflicts);
+            return 1;
         }
         std::swap(conflicts, lastConflicts);
-        conflicts = getConflicts();
+        conflicts = currentConflicts;
         //std::cout << "i: " << i << " c: " << conflicts << std::endl;
         iTolerance = conflicts == lastConflicts ? iTolerance + 1 : 0;
         if (iTolerance > tolerance)
         {
-            fitness = conflicts;
-            return i;
+            restoreFitness(conflicts);
+            return 1;
         }
     }
-    fitness = conflicts;
-    return repetitions;
+    restoreFitness(conflicts);
+    return 1;
 }
 
-bool Sudoku::stochasticLocalSearchSquare(int k, int l, size_t step)
+template<size_t B>
+bool BasicSudoku<B>::stochasticLocalSearchSquare(int k, int l)
 {
-    int conflicts = getConflicts();
+    const Board &original = instance->getOriginal();
     bool improveSquare = false;
     size_t m = 1;
     for (size_t i = k; i < k + step; i++)
     {
-        for (size_t j = l; j < l + step && m < solution.size(); j++, m++)
+        for (size_t j = l; j < l + step && m < sudokuSize; j++, m++)
         {
 
-            if (original[i][j] == 0)
+            if (original(i, j) == 0)
             {
                 bool improve = false;
-                std::vector<int> options(solution.size() - m);
-                std::iota(options.begin(), options.end(), m);
-                std::random_shuffle(options.begin(), options.end());
-                while (!options.empty() && !improve)
+                std::array<uint8_t, sudokuSize> options;
+                size_t n = sudokuSize - m;
+                std::iota(options.begin(), options.begin() + n, m);
+                gen.shuffle(options.begin(), options.begin() + n);
+                for (; n > 0 && !improve; n--)
                 {
-                    int ii = k + options.back() / step, jj = l + options.back() % step;
-                    if (original[ii][jj] == 0)
+                    int ii = k + options[n - 1] / step, jj = l + options[n - 1] % step;
+                    if (original(ii, jj) == 0 && isSwapAllowed(ii, jj, i, j))
                     {
-                        std::swap(solution[ii][jj], solution[i][j]);
-                        int tempConflicts = getConflicts();
-                        if (tempConflicts > conflicts)
-                        {
-                            std::swap(solution[ii][jj], solution[i][j]);
-                        }
-                        else
+                        GA_COUNT(SwapsTried, 1);
+                        if (getSwapDelta(ii, jj, i, j) <= 0)
                         {
+                            GA_COUNT(SwapsAccepted, 1);
+                            applySwap(ii, jj, i, j);
                             improveSquare = improve = true;
-                            conflicts = tempConflicts;
                         }
                     }
-                    options.pop_back();
                 }
             }
         }
@@ -450,21 +494,23 @@ bool Sudoku::stochasticLocalSearchSquare(int k, int l, size_t step)
     return improveSquare;
 }
 
-size_t Sudoku::stochasticLocalSearchAll(size_t repetitions)
+template<size_t B>
+size_t BasicSudoku<B>::stochasticLocalSearchAll(size_t repetitions)
 {
-    conflictsTable.resize(original.size(), std::vector<int>(original.size()));
+    CostTable conflictsTable;
     int iTolerance = 0, tolerance = repetitions * .25;
     int lastConflicts, conflicts;
     lastConflicts = getConflicts();
-    std::vector<int> blocks(original.size());
+    Assignment assignment;
+    std::array<int, sudokuSize> blocks;
     std::iota(blocks.begin(), blocks.end(), 0);
     for (size_t i = 0; i < repetitions; i++)
     {
-        std::random_shuffle(blocks.begin(), blocks.end());
+        gen.shuffle(blocks.begin(), blocks.end());
         for (auto j : blocks)
         {
             int k = (j / step) * step, l = (j % step) * step;
-            stochasticLocalSearchAllSquare(k, l);
+            stochasticLocalSearchAllSquare(k, l, assignment, conflictsTable);
         }
         conflicts = getConflicts();
         if (conflicts == 0)
@@ -482,85 +528,94 @@ size_t Sudoku::stochasticLocalSearchAll(size_t repetitions)
     return repetitions;
 }
 
-bool Sudoku::stochasticLocalSearchAllSquare(size_t k, size_t l)
+template<size_t B>
+bool BasicSudoku<B>::stochasticLocalSearchAllSquare(size_t k, size_t l, Assignment &assignment, CostTable &conflictsTable)
 {
-    std::vector<unsigned short> *freeCells = &tableFreeCells[l / step + k];
-    std::vector<unsigned short> solutionBlock;
-    std::vector<unsigned short> zeroVec(original.size(), 0);
-    setSquare(zeroVec, k, l);
-    int index, best = 100000;
+    const Board &original = instance->getOriginal();
+    const std::vector<unsigned short> &freeCells = instance->getFreeCells(l / step + k);
+    const std::vector<unsigned short> &missing = instance->getMissingNumbers(l / step + k);
+    const int excludedCost = 4 * sudokuSize * weightOriginalConflict;
+    UnitValues options, solutionBlock;
+    std::copy(missing.begin(), missing.end(), options.begin());
+    solutionBlock.fill(0);
+    setSquare(solutionBlock.data(), k, l);
     size_t cell = 0;
     for (size_t i = k; i < k + step; i++)
     {
         for (size_t j = l; j < l + step; j++, cell++)
         {
-            for (auto option : missingNumbersTable[l / step + k])
+            for (auto option : missing)
             {
-                if (original[i][j] == 0)
+                if (original(i, j) == 0)
                 {
-                    conflictsTable[cell][option - 1] = getConflicts(option, i, j);
+                    conflictsTable(cell, option - 1) = instance->isCandidate(i, j, option) ? getConflicts(option, i, j) : excludedCost;
                 }
             }
         }
     }
-    permutationsBlock = &permutationsPerBlock[l / step + k];
-    std::vector<size_t> permutationsIndex(permutationsBlock->size());
-    std::iota(permutationsIndex.begin(), permutationsIndex.end(), 0);
-    std::random_shuffle(permutationsIndex.begin(), permutationsIndex.end());
-    for (auto j : permutationsIndex)
+    gen.shuffle(options.begin(), options.begin() + missing.size());
+    assignment.resize(missing.size());
+    for (size_t i = 0; i < freeCells.size(); i++)
     {
-        int conflicts = 0;
-        for (size_t i = 0; i < (*permutationsBlock)[j].size(); i++)
+        for (size_t j = 0; j < missing.size(); j++)
         {
-            conflicts += conflictsTable[(*freeCells)[i]][(*permutationsBlock)[j][i] - 1];
-        }
-        if (conflicts < best)
-        {
-            best = conflicts;
-            index = j;
+            assignment.cost(i, j) = conflictsTable(freeCells[i], options[j] - 1);
         }
     }
-    solutionBlock = (*permutationsBlock)[index];
-    setSquare(solutionBlock, k, l);
+    assignment.solve();
+    for (size_t i = 0; i < missing.size(); i++)
+    {
+        solutionBlock[i] = options[assignment.getColumn(i)];
+    }
+    setSquare(solutionBlock.data(), k, l);
     return true;
 }
 
-void Sudoku::simulatedAnnealing(double t, double tMin)
+template<size_t B>
+void BasicSudoku<B>::simulatedAnnealing(double t, double tMin)
 {
-    std::vector<unsigned short> options;
+    UnitValues options;
+    size_t n;
     int deltaE;
     int k, l, i1, i2, j1, j2;
-    int fitnessNeighbour;
-    int fitnessActual = getConflictsRowsAndCols();
+    int fitnessActual = initConflictCounters();
+    size_t swappableBlocks = 0;
+    for (size_t block = 0; block < sudokuSize; block++)
+    {
+        swappableBlocks += instance->getFreeCells(block).size() > 1;
+    }
+    if (fitnessActual == 0 || swappableBlocks == 0)
+    {
+        return;
+    }
     while (tMin < t)
     {
         int i = 0;
         while (i++ < 100)
         {
-            std::cout << fitnessActual << " " << t << std::endl;
             do
             {
-                k = (rand() % step) * step;
-                l = (rand() % step) * step;
-                options = tableFreeCells[l / step + k];
-            } while (options.size() < 2);
-            std::random_shuffle(options.begin(), options.end());
+                k = gen.below(step) * step;
+                l = gen.below(step) * step;
+                n = instance->getFreeCells(l / step + k).size();
+            } while (n < 2);
+            const std::vector<unsigned short> &freeCells = instance->getFreeCells(l / step + k);
+            std::copy(freeCells.begin(), freeCells.end(), options.begin());
+            gen.shuffle(options.begin(), options.begin() + n);
             i1 = k + options[0] / step, j1 = l + options[0] % step;
             i2 = k + options[1] / step, j2 = l + options[1] % step;
-            std::swap(solution[i1][j1], solution[i2][j2]);
-            fitnessNeighbour = getConflictsRowsAndCols();
-            deltaE = fitnessNeighbour - fitnessActual;
-            if (deltaE <= 0 || (rand() % 100) / 100.0 < exp(-deltaE / t))
+            if (!isSwapAllowed(i1, j1, i2, j2))
             {
-                fitnessActual = fitnessNeighbour;
+                continue;
             }
-            else
+            deltaE = getSwapDelta(i1, j1, i2, j2);
+            if (deltaE <= 0 || gen.probability() < exp(-deltaE / t))
             {
-                std::swap(solution[i1][j1], solution[i2][j2]);
+                applySwap(i1, j1, i2, j2);
+                fitnessActual = currentConflicts;
             }
             if (fitnessActual == 0)
             {
-                std::cout << "Resuelto\n";
                 return;
             }
         }
@@ -568,87 +623,137 @@ void Sudoku::simulatedAnnealing(double t, double tMin)
     }
 }
 
-void Sudoku::setFitness()
+template<size_t B>
+void BasicSudoku<B>::setFitness()
 {
-    fitness = getConflictsRowsAndCols();
+    restoreFitness(getConflictsRowsAndCols());
 }
 
-void Sudoku::mutate(double probability)
+template<size_t B>
+void BasicSudoku<B>::mutate(double probability)
 {
-    for (size_t k = 0; k < solution.size(); k += step)
+    Assignment assignment;
+    for (size_t k = 0; k < sudokuSize; k += step)
     {
-        for (size_t l = 0; l < solution.size(); l += step)
+        for (size_t l = 0; l < sudokuSize; l += step)
         {
-            if (randProbability(gen) < probability)
+            if (gen.probability() < probability)
             {
-                std::vector<unsigned short> options = tableFreeCells[l / step + k];
-                std::random_shuffle(options.begin(), options.end());
-                int i1 = k + options[0] / step, j1 = l + options[0] % step;
-                int i2 = k + options[1] / step, j2 = l + options[1] % step;
-                std::swap(solution[i1][j1], solution[i2][j2]);
+                const std::vector<unsigned short> &freeCells = instance->getFreeCells(l / step + k);
+                std::array<uint8_t, sudokuSize> options;
+                std::copy(freeCells.begin(), freeCells.end(), options.begin());
+                gen.shuffle(options.begin(), options.begin() + freeCells.size());
+                bool swapped = false;
+                for (size_t a = 0; a < freeCells.size() && !swapped; a++)
+                {
+                    for (size_t b = a + 1; b < freeCells.size() && !swapped; b++)
+                    {
+                        int i1 = k + options[a] / step, j1 = l + options[a] % step;
+                        int i2 = k + options[b] / step, j2 = l + options[b] % step;
+                        if (isSwapAllowed(i1, j1, i2, j2))
+                        {
+                            std::swap(solution(i1, j1), solution(i2, j2));
+                            swapped = true;
+                            dirty = true;
+                        }
+                    }
+                }
+                // No swap keeps the candidates, e.g. the free cells hold a
+                // cycle like {a,b}, {b,c}, {c,a} = (b,c,a): the block is drawn
+                // again, so it can still reach the other consistent blocks.
+                if (!swapped && freeCells.size() > 1)
+                {
+                    createRandomSquare(k, l, assignment);
+                }
             }
         }
     }
 }
 
-void Sudoku::cross(const Individual &partner, const size_t pos)
+template<size_t B>
+void BasicSudoku<B>::cross(const BasicSudoku &partner, size_t pos)
 {
     size_t k = (pos / step) * step, l = (pos % step) * step;
-    const std::vector<std::vector<unsigned short>> &solP = static_cast<const Sudoku &>(partner).getSolution();
-    for (; k < solution.size(); k += step)
+    const SolutionBoard &solP = partner.getSolution();
+    dirty = true;
+    for (; k < sudokuSize; k += step)
     {
-        for (; l < solution.size(); l += step)
+        for (; l < sudokuSize; l += step)
         {
             for (size_t i = k; i < k + step; i++)
             {
                 for (size_t j = l; j < l + step; j++)
                 {
-                    solution[i][j] = solP[i][j];
+                    solution(i, j) = solP(i, j);
                 }
             }
         }
     }
 }
 
-void Sudoku::setDCN(const std::vector<Sudoku> &survivors)
+template<size_t B>
+double BasicSudoku<B>::getDistance(const BasicSudoku &sud) const
 {
-    dcn = getDistance(survivors[0]);
-    for (size_t i = 1; i < survivors.size(); i++)
-    {
-        double temp = getDistance(survivors[i]);
-        if (temp < dcn)
-        {
-            dcn = temp;
-        }
-    }
+    return kernels::hammingDistance(solution.data(), sud.getSolution().data(), sudokuSize * sudokuSize);
+}
+
+template<size_t B>
+void BasicSudoku<B>::setSeed(uint64_t seed)
+{
+    gen.seed(seed);
+}
+
+template<size_t B>
+void BasicSudoku<B>::initRandom()
+{
+    createRandomSolution();
+    setFitness();
+}
+
+template<size_t B>
+size_t BasicSudoku<B>::getStateSize() const
+{
+    return sizeof(double) + 4 * sizeof(uint64_t) + sudokuSize * sudokuSize;
 }
 
-double Sudoku::getDistance(const Sudoku &sud)
+template<size_t B>
+void BasicSudoku<B>::saveState(uint8_t *state) const
 {
-    const std::vector<std::vector<unsigned short>> solution2 = sud.getSolution();    
-    double dcn = 0;
-    for (size_t i = 0; i < solution.size(); i++)
+    uint64_t random[4];
+    gen.getState(random);
+    std::memcpy(state, &fitness, sizeof(double));
+    std::memcpy(state + sizeof(double), random, sizeof random);
+    std::memcpy(state + sizeof(double) + sizeof random, solution.data(), sudokuSize * sudokuSize);
+}
+
+// Rejects boards with digits out of range or that do not keep the clues.
+template<size_t B>
+bool BasicSudoku<B>::loadState(const uint8_t *state)
+{
+    const Board &original = instance->getOriginal();
+    const uint8_t *board = state + sizeof(double) + 4 * sizeof(uint64_t);
+    for (size_t cell = 0; cell < sudokuSize * sudokuSize; cell++)
     {
-        for (size_t j = 0; j < solution.size(); j++)
+        if (board[cell] < 1 || board[cell] > sudokuSize || (original.data()[cell] != 0 && original.data()[cell] != board[cell]))
         {
-            if (solution[i][j] != solution2[i][j])
-            {
-                dcn++;
-            }
+            return false;
         }
     }
-    return dcn;
+    uint64_t random[4];
+    std::memcpy(&fitness, state, sizeof(double));
+    std::memcpy(random, state + sizeof(double), sizeof random);
+    std::memcpy(solution.data(), board, sudokuSize * sudokuSize);
+    gen.setState(random);
+    dirty = false;
+    return true;
 }
 
-void Sudoku::initRandom()
+template<size_t B>
+size_t BasicSudoku<B>::getGenotypeLength() const
 {
-    std::random_device rd;
-    gen.seed(rd());
-    createRandomSolution();
-    setFitness();
+    return sudokuSize;
 }
 
-size_t Sudoku::getGenotypeLength() const
-{
-    return original.size();
-}
\ No newline at end of file
+template class BasicSudoku<3>;
+template class BasicSudoku<4>;
+template class BasicSudoku<5>;
@@ -9,51 +9,76 @@
 #include <cmath>
 #include <numeric>
 #include <algorithm>
-#include <random>
+#include <memory>
+#include <array>
+#include <type_traits>
 
 #include <cstring>
 
 #include <iostream>
 
 #include "Individual.hpp"
-
-class Sudoku : public Individual
+#include "Grid.hpp"
+#include "Random.hpp"
+#include "SudokuInstance.hpp"
+#include "SudokuKernels.hpp"
+#include "Assignment.hpp"
+#include "Telemetry.hpp"
+
+// The engine is compiled for each block size, so every dimension is a
+// constant and the row, column and block loops have fixed trip counts.
+// Sudoku.cpp instantiates 9x9, 16x16 and 25x25 boards.
+template<size_t B>
+class BasicSudoku : public Individual<BasicSudoku<B>>
 {
+public:
+  static constexpr size_t step = B;
+  static constexpr size_t sudokuSize = B * B;
+  // One bit per digit, bit 0 unused.
+  typedef typename std::conditional<(sudokuSize < 16), uint16_t, uint32_t>::type Mask;
+  // Boards and counters are stored inline, so a population is one contiguous
+  // block and copying an individual never allocates.
+  typedef FixedGrid<uint8_t, sudokuSize> SolutionBoard;
 
 private:
+  typedef Individual<BasicSudoku<B>> Base;
+  using Base::fitness;
+  using Base::dirty;
+
+  // Scratch buffers of the local searches live on the stack; sudokuSize
+  // bounds every digit or cell list of a unit.
+  typedef std::array<uint8_t, sudokuSize> UnitValues;
+  typedef FixedGrid<int, sudokuSize> CostTable;
+
   size_t weightOriginalConflict = 20;
-  size_t step;
-  size_t sudokuSize;
-  std::vector<std::vector<unsigned short>> solution;
-  std::vector<std::vector<unsigned short>> original;
-  std::vector<std::vector<int>> conflictsTable;
-  std::vector<std::vector<int>> conflictsPermutationTable;
-  std::vector<std::vector<unsigned short>> tableFreeCells;
-  std::vector<std::vector<std::vector<unsigned short>>> permutationsPerBlock;
-  std::vector<std::vector<unsigned short>> *permutationsBlock;
-  std::vector<std::vector<unsigned short>> missingNumbersTable;
-
-  std::mt19937 gen;
-  std::uniform_real_distribution<> randProbability;
-
-  void print(std::vector<std::vector<unsigned short>> &board);
-  int getConflicts(std::vector<int> &hist);
-  int getConflicts(unsigned short value, size_t k, size_t l);
-  void setPermutationsPerBlock();
-  void initMissingNumbersTable();
-  void setFreeCells();
-  void setSquare(std::vector<unsigned short> &values, size_t k, size_t l);
+  SolutionBoard solution;
+  FixedGrid<unsigned short, sudokuSize> rowCount;
+  FixedGrid<unsigned short, sudokuSize> colCount;
+  int currentConflicts;
+  std::shared_ptr<const SudokuInstance> instance;
+
+  Random gen;
+
+  void print(const uint8_t *board);
+  int getConflicts(const std::array<int, sudokuSize> &hist) const;
+  int getConflicts(unsigned short value, size_t k, size_t l) const;
+  int getUnitConflicts(unsigned short count, unsigned short clues) const;
+  int getUnitDelta(const unsigned short *count, const unsigned short *clues, unsigned short removed, unsigned short added) const;
+  void setSquare(const uint8_t *values, size_t k, size_t l);
   void createConstructiveHeuristicSquare(int k, int l);
-  std::vector<unsigned short> getMissingElementsSquare(size_t k, size_t l);
-  std::vector<unsigned short> getSuffledMissingElementsSquare(size_t k, size_t l);
-  bool stochasticLocalSearchSquare(int k, int l, size_t step);
-  bool stochasticLocalSearchAllSquare(size_t k, size_t l);
-  void createRandomSquare(int k, int l);
-  bool readFromFile(std::string filename);
+  size_t getSuffledMissingElementsSquare(size_t k, size_t l, UnitValues &options);
+  bool stochasticLocalSearchSquare(int k, int l);
+  bool stochasticLocalSearchAllSquare(size_t k, size_t l, Assignment &assignment, CostTable &conflictsTable);
+  void createRandomSquare(size_t k, size_t l, Assignment &assignment);
 
 public:
-  Sudoku() = default;
-  Sudoku(std::string filename);
+  using Base::restoreFitness;
+
+  BasicSudoku() = default;
+  BasicSudoku(std::string filename);
+  BasicSudoku(std::shared_ptr<const SudokuInstance> instance);
+
+  bool isValid() const;
 
   void createSolution(bool useRandom);
   void createRandomSolution();
@@ -65,23 +90,69 @@ public:
   void printOriginal();
   void printSolution();
 
-  const std::vector<std::vector<unsigned short>> &getSolution() const;
+  const SolutionBoard &getSolution() const;
 
   int getConflicts();
-  int getConflictsRows();
-  int getConflictsCols();
-  int getConflictsRowsAndCols();
-  int getConflictsSquare();
+  int getConflictsRows() const;
+  int getConflictsCols() const;
+  int getConflictsRowsAndCols() const;
+  int getConflictsSquare() const;
+
+  int initConflictCounters();
+  bool isSwapAllowed(size_t i1, size_t j1, size_t i2, size_t j2) const;
+  int getSwapDelta(size_t i1, size_t j1, size_t i2, size_t j2) const;
+  void applySwap(size_t i1, size_t j1, size_t i2, size_t j2);
 
   void simulatedAnnealing(double t, double tMin);
 
+  void setSeed(uint64_t seed);
   void initRandom();
+
+  // Checkpoint record: fitness, generator state and board.
+  size_t getStateSize() const;
+  void saveState(uint8_t *state) const;
+  bool loadState(const uint8_t *state);
+
   void setFitness();
   void mutate(double probability);
-  void cross(const Individual &individual, const size_t pos);
+  void cross(const BasicSudoku &partner, size_t pos);
   size_t getGenotypeLength() const;
-  void setDCN(const std::vector<Sudoku> &survivors);
-  double getDistance(const Sudoku &sud);
+  double getDistance(const BasicSudoku &sud) const;
 };
 
+template<size_t B>
+constexpr size_t BasicSudoku<B>::step;
+template<size_t B>
+constexpr size_t BasicSudoku<B>::sudokuSize;
+
+extern template class BasicSudoku<3>;
+extern template class BasicSudoku<4>;
+extern template class BasicSudoku<5>;
+
+typedef BasicSudoku<3> Sudoku;
+
+// Calls f with std::integral_constant<size_t, B> for the block size of the
+// instance. Returns false when that size has no instantiation.
+template<class F>
+bool dispatchBlockSize(const SudokuInstance &instance, F f)
+{
+  if (instance.getStep() * instance.getStep() != instance.getSize())
+  {
+    return false;
+  }
+  switch (instance.getStep())
+  {
+  case 3:
+    f(std::integral_constant<size_t, 3>());
+    return true;
+  case 4:
+    f(std::integral_constant<size_t, 4>());
+    return true;
+  case 5:
+    f(std::integral_constant<size_t, 5>());
+    return true;
+  }
+  return false;
+}
+
 #endif //SUDOKU_HPP
\ No newline at end of file
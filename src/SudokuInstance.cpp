@@ -0,0 +1,310 @@
+#include "SudokuInstance.hpp"
+
+SudokuInstance::SudokuInstance(std::string filename) : sudokuSize(0)
+{
+    valid = readFromFile(filename);
+    setTables();
+}
+
+SudokuInstance::SudokuInstance(const Board &original) : sudokuSize(original.getSize()), original(original), valid(true)
+{
+    setTables();
+}
+
+void SudokuInstance::setTables()
+{
+    step = sqrt(sudokuSize);
+    if (!presolve())
+    {
+        std::cout << "El sudoku no tiene solucion, se omite la propagacion" << std::endl;
+    }
+    initMissingNumbersTable();
+    setFreeCells();
+    setClues();
+}
+
+// Naked and hidden singles are repeated until nothing changes; pointing pairs
+// only run when the singles are exhausted. If a cell or a unit runs out of
+// candidates the puzzle is left as it was read.
+bool SudokuInstance::presolve()
+{
+    const Board given = original;
+    const uint32_t all = ((1u << sudokuSize) - 1) << 1;
+    candidates = Grid<uint32_t>(sudokuSize, all);
+    presolvedCells = 0;
+    for (size_t i = 0; i < sudokuSize; i++)
+    {
+        for (size_t j = 0; j < sudokuSize; j++)
+        {
+            if (original(i, j) != 0)
+            {
+                place(i, j, original(i, j));
+            }
+        }
+    }
+    bool changed = true, valid = true;
+    while (valid && changed)
+    {
+        changed = false;
+        valid = setNakedSingles(changed) && setHiddenSingles(changed);
+        if (valid && !changed)
+        {
+            removePointingPairs(changed);
+        }
+    }
+    if (!valid)
+    {
+        original = given;
+        presolvedCells = 0;
+        for (size_t i = 0; i < sudokuSize; i++)
+        {
+            for (size_t j = 0; j < sudokuSize; j++)
+            {
+                candidates(i, j) = original(i, j) != 0 ? 1u << original(i, j) : all;
+            }
+        }
+    }
+    return valid;
+}
+
+void SudokuInstance::place(size_t i, size_t j, unsigned short value)
+{
+    const uint32_t bit = 1u << value;
+    const size_t k = i / step * step, l = j / step * step;
+    original(i, j) = value;
+    candidates(i, j) = bit;
+    for (size_t t = 0; t < sudokuSize; t++)
+    {
+        if (original(i, t) == 0)
+        {
+            candidates(i, t) &= ~bit;
+        }
+        if (original(t, j) == 0)
+        {
+            candidates(t, j) &= ~bit;
+        }
+        if (original(k + t / step, l + t % step) == 0)
+        {
+            candidates(k + t / step, l + t % step) &= ~bit;
+        }
+    }
+}
+
+bool SudokuInstance::setNakedSingles(bool &changed)
+{
+    for (size_t i = 0; i < sudokuSize; i++)
+    {
+        for (size_t j = 0; j < sudokuSize; j++)
+        {
+            uint32_t mask = candidates(i, j);
+            if (original(i, j) != 0)
+            {
+                continue;
+            }
+            if (mask == 0)
+            {
+                return false;
+            }
+            if ((mask & (mask - 1)) == 0)
+            {
+                place(i, j, __builtin_ctz(mask));
+                presolvedCells++;
+                changed = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool SudokuInstance::setHiddenSingles(bool &changed)
+{
+    size_t i, j;
+    for (size_t unit = 0; unit < 3 * sudokuSize; unit++)
+    {
+        for (unsigned short value = 1; value <= sudokuSize; value++)
+        {
+            bool found = false;
+            size_t count = 0, last = 0;
+            for (size_t cell = 0; cell < sudokuSize && !found; cell++)
+            {
+                getUnitCell(unit, cell, i, j);
+                found = original(i, j) == value;
+                if (original(i, j) == 0 && (candidates(i, j) & (1u << value)))
+                {
+                    count++;
+                    last = cell;
+                }
+            }
+            if (found)
+            {
+                continue;
+            }
+            if (count == 0)
+            {
+                return false;
+            }
+            if (count == 1)
+            {
+                getUnitCell(unit, last, i, j);
+                place(i, j, value);
+                presolvedCells++;
+                changed = true;
+            }
+        }
+    }
+    return true;
+}
+
+// When every candidate position of a value inside a block lies on one row (or
+// column), the value can be removed from the rest of that row (or column).
+void SudokuInstance::removePointingPairs(bool &changed)
+{
+    for (size_t k = 0; k < sudokuSize; k += step)
+    {
+        for (size_t l = 0; l < sudokuSize; l += step)
+        {
+            for (unsigned short value = 1; value <= sudokuSize; value++)
+            {
+                const uint32_t bit = 1u << value;
+                uint32_t rows = 0, cols = 0;
+                bool found = false;
+                for (size_t i = k; i < k + step; i++)
+                {
+                    for (size_t j = l; j < l + step; j++)
+                    {
+                        found = found || original(i, j) == value;
+                        if (original(i, j) == 0 && (candidates(i, j) & bit))
+                        {
+                            rows |= 1u << (i - k);
+                            cols |= 1u << (j - l);
+                        }
+                    }
+                }
+                if (found || rows == 0)
+                {
+                    continue;
+                }
+                for (size_t t = 0; t < sudokuSize; t++)
+                {
+                    size_t i = k + __builtin_ctz(rows), j = l + __builtin_ctz(cols);
+                    if ((rows & (rows - 1)) == 0 && (t < l || t >= l + step) && original(i, t) == 0 && (candidates(i, t) & bit))
+                    {
+                        candidates(i, t) &= ~bit;
+                        changed = true;
+                    }
+                    if ((cols & (cols - 1)) == 0 && (t < k || t >= k + step) && original(t, j) == 0 && (candidates(t, j) & bit))
+                    {
+                        candidates(t, j) &= ~bit;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Units are numbered rows first, then columns, then blocks.
+void SudokuInstance::getUnitCell(size_t unit, size_t cell, size_t &i, size_t &j) const
+{
+    size_t n = unit % sudokuSize;
+    if (unit < sudokuSize)
+    {
+        i = n;
+        j = cell;
+    }
+    else if (unit < 2 * sudokuSize)
+    {
+        i = cell;
+        j = n;
+    }
+    else
+    {
+        i = n / step * step + cell / step;
+        j = n % step * step + cell % step;
+    }
+}
+
+bool SudokuInstance::readFromFile(std::string filename)
+{
+    PuzzleReader reader;
+    std::vector<PuzzleReader::Puzzle> puzzles;
+    if (!reader.readFile(filename, puzzles) || puzzles.empty())
+    {
+        return false;
+    }
+    original = std::move(puzzles[0].board);
+    sudokuSize = original.getSize();
+    return true;
+}
+
+void SudokuInstance::setClues()
+{
+    rowClues = Grid<unsigned short>(sudokuSize, 0);
+    colClues = Grid<unsigned short>(sudokuSize, 0);
+    rowClueMask.assign(sudokuSize, 0);
+    colClueMask.assign(sudokuSize, 0);
+    for (size_t i = 0; i < sudokuSize; i++)
+    {
+        for (size_t j = 0; j < sudokuSize; j++)
+        {
+            if (original(i, j) != 0)
+            {
+                rowClues(i, original(i, j) - 1)++;
+                colClues(j, original(i, j) - 1)++;
+                rowClueMask[i] |= 1u << original(i, j);
+                colClueMask[j] |= 1u << original(i, j);
+            }
+        }
+    }
+}
+
+void SudokuInstance::initMissingNumbersTable()
+{
+    missingNumbersTable.resize(sudokuSize);
+    for (size_t k = 0; k < sudokuSize; k += step)
+    {
+        for (size_t l = 0; l < sudokuSize; l += step)
+        {
+            missingNumbersTable[l / step + k] = getMissingElementsSquare(k, l);
+        }
+    }
+}
+
+void SudokuInstance::setFreeCells()
+{
+    tableFreeCells.resize(sudokuSize);
+    for (size_t k = 0; k < sudokuSize; k += step)
+    {
+        for (size_t l = 0; l < sudokuSize; l += step)
+        {
+            unsigned short cell = 0;
+            for (size_t i = k; i < k + step; i++)
+            {
+                for (size_t j = l; j < l + step; j++, cell++)
+                {
+                    if (original(i, j) == 0)
+                    {
+                        tableFreeCells[l / step + k].push_back(cell);
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<unsigned short> SudokuInstance::getMissingElementsSquare(size_t k, size_t l) const
+{
+    std::vector<unsigned short> options(sudokuSize);
+    std::iota(options.begin(), options.end(), 1);
+    for (size_t i = k; i < k + step; i++)
+    {
+        for (size_t j = l; j < l + step; j++)
+        {
+            if (original(i, j) != 0)
+            {
+                options.erase(std::find(options.begin(), options.end(), original(i, j)));
+            }
+        }
+    }
+    return options;
+}
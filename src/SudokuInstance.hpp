@@ -0,0 +1,69 @@
+#ifndef SUDOKU_INSTANCE_HPP
+#define SUDOKU_INSTANCE_HPP
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <iostream>
+
+#include "Grid.hpp"
+#include "PuzzleReader.hpp"
+
+// Puzzle data that never changes during a run. It is shared by pointer between
+// every Sudoku individual of a population. Before the tables are built the
+// puzzle is presolved by constraint propagation: forced cells are written into
+// original and every free cell keeps a bitmask of its remaining candidates
+// (bit 1u << digit, as the clue masks).
+class SudokuInstance
+{
+private:
+  size_t step;
+  size_t sudokuSize;
+  Board original;
+  Grid<unsigned short> rowClues;
+  Grid<unsigned short> colClues;
+  std::vector<uint32_t> rowClueMask;
+  std::vector<uint32_t> colClueMask;
+  Grid<uint32_t> candidates;
+  size_t presolvedCells;
+  bool valid;
+  std::vector<std::vector<unsigned short>> tableFreeCells;
+  std::vector<std::vector<unsigned short>> missingNumbersTable;
+
+  bool readFromFile(std::string filename);
+  void setTables();
+  bool presolve();
+  void place(size_t i, size_t j, unsigned short value);
+  bool setNakedSingles(bool &changed);
+  bool setHiddenSingles(bool &changed);
+  void removePointingPairs(bool &changed);
+  void getUnitCell(size_t unit, size_t cell, size_t &i, size_t &j) const;
+  void initMissingNumbersTable();
+  void setFreeCells();
+  void setClues();
+  std::vector<unsigned short> getMissingElementsSquare(size_t k, size_t l) const;
+
+public:
+  // Reads the first puzzle of the file, in either format of PuzzleReader. When
+  // the file cannot be read the instance is empty and isValid is false.
+  SudokuInstance(std::string filename);
+  SudokuInstance(const Board &original);
+
+  bool isValid() const { return valid; }
+  size_t getStep() const { return step; }
+  size_t getSize() const { return sudokuSize; }
+  const Board &getOriginal() const { return original; }
+  const Grid<unsigned short> &getRowClues() const { return rowClues; }
+  const Grid<unsigned short> &getColClues() const { return colClues; }
+  const uint32_t *getRowClueMask() const { return rowClueMask.data(); }
+  const uint32_t *getColClueMask() const { return colClueMask.data(); }
+  uint32_t getCandidates(size_t i, size_t j) const { return candidates(i, j); }
+  bool isCandidate(size_t i, size_t j, unsigned short value) const { return candidates(i, j) & (1u << value); }
+  size_t getPresolvedCells() const { return presolvedCells; }
+  const std::vector<unsigned short> &getFreeCells(size_t block) const { return tableFreeCells[block]; }
+  const std::vector<unsigned short> &getMissingNumbers(size_t block) const { return missingNumbersTable[block]; }
+};
+
+#endif // SUDOKU_INSTANCE_HPP
@@ -0,0 +1,173 @@
+#include "SudokuKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace kernels
+{
+namespace
+{
+typedef size_t (*HammingFunction)(const uint8_t *, const uint8_t *, size_t);
+typedef int (*ConflictsFunction)(const uint8_t *, size_t, const uint32_t *, const uint32_t *, int);
+
+struct Dispatch
+{
+    HammingFunction hamming;
+    ConflictsFunction conflicts;
+    const char *instructionSet;
+};
+
+// Digits go up to 25, so one 32 bit mask per unit is enough.
+const size_t maxSize = 32;
+
+inline int unitConflicts(size_t size, uint32_t seen, uint32_t dup, uint32_t clueMask, int weight)
+{
+    return 2 * (size - __builtin_popcount(seen)) + weight * __builtin_popcount(dup & clueMask);
+}
+
+int rowConflicts(const uint8_t *board, size_t size, const uint32_t *rowClueMask, int weight)
+{
+    int conflicts = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        const uint8_t *row = board + i * size;
+        uint32_t seen = 0, dup = 0;
+        for (size_t j = 0; j < size; j++)
+        {
+            uint32_t bit = 1u << row[j];
+            dup |= seen & bit;
+            seen |= bit;
+        }
+        conflicts += unitConflicts(size, seen, dup, rowClueMask[i], weight);
+    }
+    return conflicts;
+}
+
+int colConflicts(const uint8_t *board, size_t size, const uint32_t *colClueMask, int weight, size_t first)
+{
+    uint32_t seen[maxSize] = {0}, dup[maxSize] = {0};
+    for (size_t i = 0; i < size; i++)
+    {
+        const uint8_t *row = board + i * size;
+        for (size_t j = first; j < size; j++)
+        {
+            uint32_t bit = 1u << row[j];
+            dup[j] |= seen[j] & bit;
+            seen[j] |= bit;
+        }
+    }
+    int conflicts = 0;
+    for (size_t j = first; j < size; j++)
+    {
+        conflicts += unitConflicts(size, seen[j], dup[j], colClueMask[j], weight);
+    }
+    return conflicts;
+}
+
+size_t hammingScalar(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t distance = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        distance += a[i] != b[i];
+    }
+    return distance;
+}
+
+int conflictsScalar(const uint8_t *board, size_t size, const uint32_t *rowClueMask, const uint32_t *colClueMask, int weight)
+{
+    return rowConflicts(board, size, rowClueMask, weight) + colConflicts(board, size, colClueMask, weight, 0);
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("sse2,popcnt"))) size_t hammingSSE2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t distance = 0, i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+        distance += 16 - __builtin_popcount(_mm_movemask_epi8(eq));
+    }
+    return distance + hammingScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2,popcnt"))) size_t hammingAVX2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t distance = 0, i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i)));
+        distance += 32 - __builtin_popcount((uint32_t)_mm256_movemask_epi8(eq));
+    }
+    return distance + hammingSSE2(a + i, b + i, n - i);
+}
+
+// Columns are processed eight at a time: each lane keeps the masks of one
+// column while the rows are streamed in order.
+__attribute__((target("avx2,popcnt"))) int conflictsAVX2(const uint8_t *board, size_t size, const uint32_t *rowClueMask, const uint32_t *colClueMask, int weight)
+{
+    int conflicts = rowConflicts(board, size, rowClueMask, weight);
+    const __m256i one = _mm256_set1_epi32(1);
+    alignas(32) uint32_t seen[8], dup[8];
+    size_t j = 0;
+    for (; j + 8 <= size; j += 8)
+    {
+        __m256i seenLanes = _mm256_setzero_si256(), dupLanes = _mm256_setzero_si256();
+        for (size_t i = 0; i < size; i++)
+        {
+            __m256i values = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(board + i * size + j)));
+            __m256i bits = _mm256_sllv_epi32(one, values);
+            dupLanes = _mm256_or_si256(dupLanes, _mm256_and_si256(seenLanes, bits));
+            seenLanes = _mm256_or_si256(seenLanes, bits);
+        }
+        _mm256_store_si256((__m256i *)seen, seenLanes);
+        _mm256_store_si256((__m256i *)dup, dupLanes);
+        for (size_t lane = 0; lane < 8; lane++)
+        {
+            conflicts += unitConflicts(size, seen[lane], dup[lane], colClueMask[j + lane], weight);
+        }
+    }
+    return conflicts + colConflicts(board, size, colClueMask, weight, j);
+}
+#endif
+
+Dispatch selectDispatch()
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    {
+        return {hammingAVX2, conflictsAVX2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2") && __builtin_cpu_supports("popcnt"))
+    {
+        return {hammingSSE2, conflictsScalar, "sse2"};
+    }
+#endif
+    return {hammingScalar, conflictsScalar, "scalar"};
+}
+
+const Dispatch &getDispatch()
+{
+    static const Dispatch dispatch = selectDispatch();
+    return dispatch;
+}
+}
+
+size_t hammingDistance(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    return getDispatch().hamming(a, b, n);
+}
+
+int rowColumnConflicts(const uint8_t *board, size_t size, const uint32_t *rowClueMask, const uint32_t *colClueMask, int weight)
+{
+    return getDispatch().conflicts(board, size, rowClueMask, colClueMask, weight);
+}
+
+const char *getInstructionSet()
+{
+    return getDispatch().instructionSet;
+}
+}
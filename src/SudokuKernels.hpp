@@ -0,0 +1,22 @@
+#ifndef SUDOKU_KERNELS_HPP
+#define SUDOKU_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Inner loops over flat byte boards. Each kernel has a portable version and,
+// on x86, vectorized versions selected at runtime from the CPU features.
+namespace kernels
+{
+// Number of positions where the boards differ.
+size_t hammingDistance(const uint8_t *a, const uint8_t *b, size_t n);
+
+// Row and column conflicts of a size x size board. Every unit costs two per
+// missing digit plus weight for each clue digit of the unit that is repeated.
+// Clue masks hold bit d for every clue d of the unit.
+int rowColumnConflicts(const uint8_t *board, size_t size, const uint32_t *rowClueMask, const uint32_t *colClueMask, int weight);
+
+const char *getInstructionSet();
+}
+
+#endif // SUDOKU_KERNELS_HPP
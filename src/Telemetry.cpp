@@ -0,0 +1,168 @@
+#include "Telemetry.hpp"
+
+#ifdef GA_TELEMETRY
+#include <atomic>
+#include <mutex>
+#include <set>
+#endif
+
+#ifdef GA_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<uint64_t> allocations(0);
+}
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size != 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace telemetry
+{
+const char *getPhaseName(size_t phase)
+{
+    static const char *names[] = {"tournament", "crossover", "mutation", "local_search", "fitness", "replacement"};
+    return names[phase];
+}
+
+const char *getCounterName(size_t counter)
+{
+    static const char *names[] = {"fitness_evaluations", "swaps_tried", "swaps_accepted"};
+    return names[counter];
+}
+
+uint64_t getAllocations()
+{
+#ifdef GA_COUNT_ALLOCATIONS
+    return allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+#ifdef GA_TELEMETRY
+namespace
+{
+struct ThreadCounters;
+
+std::mutex registryMutex;
+std::set<ThreadCounters *> registry;
+uint64_t retired[CounterCount];
+
+// Each thread increments its own counters; they are folded into retired when
+// the thread ends so short lived threads are not lost. Only the owner writes
+// them, but getCounter reads them from other threads, so they are atomic with
+// relaxed loads and stores.
+struct ThreadCounters
+{
+    std::atomic<uint64_t> values[CounterCount] = {};
+
+    ThreadCounters()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.insert(this);
+    }
+
+    ~ThreadCounters()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (size_t c = 0; c < CounterCount; c++)
+        {
+            retired[c] += values[c].load(std::memory_order_relaxed);
+        }
+        registry.erase(this);
+    }
+};
+
+thread_local ThreadCounters threadCounters;
+}
+
+void count(Counter counter, uint64_t n)
+{
+    std::atomic<uint64_t> &value = threadCounters.values[counter];
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+uint64_t getCounter(Counter counter)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t total = retired[counter];
+    for (auto c : registry)
+    {
+        total += c->values[counter].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+#endif
+
+TraceWriter::TraceWriter(const std::string &filename, bool json) : file(filename), json(json)
+{
+    if (!json && file.is_open())
+    {
+        file << "generation,seconds,best_fitness,mean_fitness,diversity";
+        for (size_t p = 0; p < PhaseCount; p++)
+        {
+            file << "," << getPhaseName(p) << "_seconds";
+        }
+        for (size_t c = 0; c < CounterCount; c++)
+        {
+            file << "," << getCounterName(c);
+        }
+        file << ",allocations" << std::endl;
+    }
+}
+
+bool TraceWriter::isOpen() const
+{
+    return file.is_open();
+}
+
+void TraceWriter::operator()(const GenerationStats &stats)
+{
+    if (json)
+    {
+        file << "{\"generation\":" << stats.generation << ",\"seconds\":" << stats.seconds << ",\"best_fitness\":" << stats.bestFitness
+             << ",\"mean_fitness\":" << stats.meanFitness << ",\"diversity\":" << stats.diversity;
+        for (size_t p = 0; p < PhaseCount; p++)
+        {
+            file << ",\"" << getPhaseName(p) << "_seconds\":" << stats.phaseSeconds[p];
+        }
+        for (size_t c = 0; c < CounterCount; c++)
+        {
+            file << ",\"" << getCounterName(c) << "\":" << stats.counters[c];
+        }
+        file << ",\"allocations\":" << stats.allocations << "}\n";
+        return;
+    }
+    file << stats.generation << "," << stats.seconds << "," << stats.bestFitness << "," << stats.meanFitness << "," << stats.diversity;
+    for (size_t p = 0; p < PhaseCount; p++)
+    {
+        file << "," << stats.phaseSeconds[p];
+    }
+    for (size_t c = 0; c < CounterCount; c++)
+    {
+        file << "," << stats.counters[c];
+    }
+    file << "," << stats.allocations << "\n";
+}
+}
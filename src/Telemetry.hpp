@@ -0,0 +1,99 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+// Per-phase timers and event counters are only compiled in when GA_TELEMETRY
+// is defined (make telemetry); otherwise GA_TIMED runs the statement alone and
+// GA_COUNT expands to nothing. Generation statistics and the observer hook are
+// always available, the phase times and counters are reported as zero when
+// telemetry is disabled. Heap allocations are counted separately, by
+// replacing the global operator new when GA_COUNT_ALLOCATIONS is defined
+// (make debug).
+namespace telemetry
+{
+enum Phase
+{
+  Tournament,
+  Crossover,
+  Mutation,
+  LocalSearch,
+  Fitness,
+  Replacement,
+  PhaseCount
+};
+
+enum Counter
+{
+  FitnessEvaluations,
+  SwapsTried,
+  SwapsAccepted,
+  CounterCount
+};
+
+const char *getPhaseName(size_t phase);
+const char *getCounterName(size_t counter);
+
+struct GenerationStats
+{
+  size_t generation;
+  double seconds;
+  double bestFitness;
+  double meanFitness;
+  double diversity;
+  double phaseSeconds[PhaseCount];
+  uint64_t counters[CounterCount];
+  uint64_t allocations;
+};
+
+// Number of calls to operator new so far, always zero unless
+// GA_COUNT_ALLOCATIONS is defined.
+uint64_t getAllocations();
+
+#ifdef GA_TELEMETRY
+// Counters are accumulated per thread and summed when read.
+void count(Counter counter, uint64_t n);
+uint64_t getCounter(Counter counter);
+
+class PhaseTimer
+{
+private:
+  double &seconds;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  PhaseTimer(double &seconds) : seconds(seconds), start(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+};
+
+#define GA_TIMED(seconds, statement)               \
+  do                                               \
+  {                                                \
+    telemetry::PhaseTimer phaseTimer(seconds);     \
+    statement;                                     \
+  } while (0)
+#define GA_COUNT(counter, n) telemetry::count(telemetry::counter, n)
+#else
+#define GA_TIMED(seconds, statement) statement
+#define GA_COUNT(counter, n)
+#endif
+
+// Writes one line per generation, as CSV or as JSON lines.
+class TraceWriter
+{
+private:
+  std::ofstream file;
+  bool json;
+
+public:
+  TraceWriter(const std::string &filename, bool json);
+  bool isOpen() const;
+  void operator()(const GenerationStats &stats);
+};
+}
+
+#endif // TELEMETRY_HPP
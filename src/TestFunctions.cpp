@@ -1,79 +1,482 @@
 #include "TestFunctions.hpp"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TEST_FUNCTIONS_X86
+#include <immintrin.h>
+#endif
+
 namespace tf
 {
+namespace
+{
+// Computes the points first, ..., count - 1 of a population.
+typedef void (*BatchFunction)(const double *, size_t, size_t, size_t, double *);
+
+struct Dispatch
+{
+    BatchFunction sphere;
+    BatchFunction ellipsoid;
+    BatchFunction zakharov;
+    BatchFunction rosenbrock;
+    BatchFunction ackley;
+    BatchFunction griewangk;
+    BatchFunction rastrigin;
+    const char *instructionSet;
+};
+
+const double twoPi = 2 * M_PI;
+
+// The cosine is evaluated with the same operations in the scalar and the
+// vector code, so both give the same bits: reduction by pi/2 in three parts
+// (exact while |x| < cosineLimit) and the fdlibm polynomials on [-pi/4, pi/4].
+// Larger arguments fall back to std::cos.
+const double cosineLimit = 1e6;
+const double twoOverPi = 6.36619772367581382433e-01;
+// Adding and subtracting 1.5 * 2^52 rounds to the nearest integer, ties to
+// even, like _mm256_round_pd.
+const double roundingShift = 6755399441055744.0;
+const double pio2[] = {1.57079632673412561417e+00, 6.07710050630396597660e-11, 2.02226624871116645580e-21};
+const double S[] = {-1.66666666666666324348e-01, 8.33333333332248946124e-03, -1.98412698298579493134e-04,
+                    2.75573137070700676789e-06, -2.50507602534068634195e-08, 1.58969099521155010221e-10};
+const double C[] = {4.16666666666666019037e-02, -1.38888888888741095749e-03, 2.48015872894767294178e-05,
+                    -2.75573143513906633035e-07, 2.08757232129817482790e-09, -1.13596475577881948265e-11};
+
+double cosine(double x)
+{
+    if (std::fabs(x) > cosineLimit)
+    {
+        return std::cos(x);
+    }
+    double k = x * twoOverPi + roundingShift - roundingShift;
+    double r = x - k * pio2[0] - k * pio2[1] - k * pio2[2];
+    double z = r * r;
+    double sp = S[5], cp = C[5];
+    for (int i = 4; i >= 0; i--)
+    {
+        sp = S[i] + z * sp;
+        cp = C[i] + z * cp;
+    }
+    long q = (long)k & 3;
+    double value = q & 1 ? r + r * z * sp : 1 - 0.5 * z + z * z * cp;
+    return (q + 1) & 2 ? -value : value;
+}
+
+// Ellipsoid weights and Griewangk divisors only depend on the number of
+// variables, so every thread keeps the last ones it used.
+const double *getEllipsoidWeights(size_t dimensions)
+{
+    thread_local std::vector<double> weights;
+    if (weights.size() != dimensions)
+    {
+        weights.resize(dimensions);
+        for (size_t i = 0; i < dimensions; i++)
+        {
+            weights[i] = pow(10, 6 * i / (dimensions - 1.));
+        }
+    }
+    return weights.data();
+}
+
+const double *getGriewangkDivisors(size_t dimensions)
+{
+    thread_local std::vector<double> divisors;
+    if (divisors.size() != dimensions)
+    {
+        divisors.resize(dimensions);
+        for (size_t i = 0; i < dimensions; i++)
+        {
+            divisors[i] = sqrt(i + 1);
+        }
+    }
+    return divisors.data();
+}
+
+void sphereScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    for (size_t k = first; k < count; k++)
+    {
+        double s = 0;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s += v * v;
+        }
+        fitness[k] = s;
+    }
+}
+
+void ellipsoidScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    const double *weights = getEllipsoidWeights(dimensions);
+    for (size_t k = first; k < count; k++)
+    {
+        double s = 0;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s += weights[d] * (v * v);
+        }
+        fitness[k] = s;
+    }
+}
+
+void zakharovScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    for (size_t k = first; k < count; k++)
+    {
+        double s1 = 0, s2 = 0;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s1 += v * v;
+            s2 += 0.5 * (d + 1) * v;
+        }
+        double square = s2 * s2;
+        fitness[k] = s1 + square + square * square;
+    }
+}
+
+void rosenbrockScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    for (size_t k = first; k < count; k++)
+    {
+        double s = 0;
+        for (size_t d = 0; d + 1 < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            double a = 1 - v, b = x[(d + 1) * count + k] - v * v;
+            s += a * a + 100 * (b * b);
+        }
+        fitness[k] = s;
+    }
+}
+
+double ackleyValue(double s1, double s2, size_t dimensions)
+{
+    return -20 * exp(-0.2 * sqrt(s1 / dimensions)) - exp(s2 / dimensions) + 20 + exp(1);
+}
+
+void ackleyScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    for (size_t k = first; k < count; k++)
+    {
+        double s1 = 0, s2 = 0;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s1 += v * v;
+            s2 += cosine(twoPi * v);
+        }
+        fitness[k] = ackleyValue(s1, s2, dimensions);
+    }
+}
+
+void griewangkScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    const double *divisors = getGriewangkDivisors(dimensions);
+    for (size_t k = first; k < count; k++)
+    {
+        double s1 = 0, m1 = 1;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s1 += v * v / 4000.;
+            m1 *= cosine(v / divisors[d]);
+        }
+        fitness[k] = s1 - m1 + 1;
+    }
+}
+
+void rastriginScalar(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    for (size_t k = first; k < count; k++)
+    {
+        double s1 = 0;
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            double v = x[d * count + k];
+            s1 += v * v - 10 * cosine(twoPi * v);
+        }
+        fitness[k] = 10. * dimensions + s1;
+    }
+}
+
+#ifdef TEST_FUNCTIONS_X86
+// Four points are computed at a time, one per lane, and the remaining ones
+// with the scalar code. FMA is not enabled, so every lane rounds exactly
+// like the scalar code does.
+__attribute__((target("avx2"))) __m256d cosineAVX2(__m256d x)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.);
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(twoOverPi)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(pio2[0])));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(pio2[1])));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(pio2[2])));
+    __m256d z = _mm256_mul_pd(r, r);
+    __m256d sp = _mm256_set1_pd(S[5]), cp = _mm256_set1_pd(C[5]);
+    for (int i = 4; i >= 0; i--)
+    {
+        sp = _mm256_add_pd(_mm256_set1_pd(S[i]), _mm256_mul_pd(z, sp));
+        cp = _mm256_add_pd(_mm256_set1_pd(C[i]), _mm256_mul_pd(z, cp));
+    }
+    __m256d sine = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), sp));
+    __m256d cosine = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1), _mm256_mul_pd(_mm256_set1_pd(0.5), z)),
+                                   _mm256_mul_pd(_mm256_mul_pd(z, z), cp));
+    __m256i q = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+    __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(q, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1));
+    __m256i negative = _mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(q, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(2)), 62);
+    __m256d value = _mm256_xor_pd(_mm256_blendv_pd(cosine, sine, _mm256_castsi256_pd(odd)), _mm256_castsi256_pd(negative));
+    __m256d large = _mm256_cmp_pd(_mm256_andnot_pd(signMask, x), _mm256_set1_pd(cosineLimit), _CMP_GT_OQ);
+    if (_mm256_movemask_pd(large) != 0)
+    {
+        alignas(32) double lanes[4], values[4];
+        _mm256_store_pd(lanes, x);
+        _mm256_store_pd(values, value);
+        for (int i = 0; i < 4; i++)
+        {
+            values[i] = std::fabs(lanes[i]) > cosineLimit ? std::cos(lanes[i]) : values[i];
+        }
+        value = _mm256_load_pd(values);
+    }
+    return value;
+}
+
+__attribute__((target("avx2"))) void sphereAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
+{
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m256d s = _mm256_setzero_pd();
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            s = _mm256_add_pd(s, _mm256_mul_pd(v, v));
+        }
+        _mm256_storeu_pd(fitness + k, s);
+    }
+    sphereScalar(x, dimensions, count, k, fitness);
+}
 
-double sphere(std::vector<double> x)
+__attribute__((target("avx2"))) void ellipsoidAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double res = 0;
-    for (auto i : x)
-        res += pow(i, 2);
-    return res;
+    const double *weights = getEllipsoidWeights(dimensions);
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m256d s = _mm256_setzero_pd();
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_set1_pd(weights[d]), _mm256_mul_pd(v, v)));
+        }
+        _mm256_storeu_pd(fitness + k, s);
+    }
+    ellipsoidScalar(x, dimensions, count, k, fitness);
 }
 
-double ellipsoid(std::vector<double> x)
+__attribute__((target("avx2"))) void zakharovAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double res = 0;
-    for (size_t i = 0; i < x.size(); i++)
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
     {
-        res += pow(10, 6 * i / (x.size() - 1.)) * pow(x[i], 2);
+        __m256d s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd();
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            s1 = _mm256_add_pd(s1, _mm256_mul_pd(v, v));
+            s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_set1_pd(0.5 * (d + 1)), v));
+        }
+        __m256d square = _mm256_mul_pd(s2, s2);
+        _mm256_storeu_pd(fitness + k, _mm256_add_pd(_mm256_add_pd(s1, square), _mm256_mul_pd(square, square)));
     }
-    return res;
+    zakharovScalar(x, dimensions, count, k, fitness);
 }
 
-double zakharov(std::vector<double> x)
+__attribute__((target("avx2"))) void rosenbrockAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double s1 = 0;
-    double s2 = 0;
-    for (size_t i = 0; i < x.size(); i++)
+    const __m256d one = _mm256_set1_pd(1), hundred = _mm256_set1_pd(100);
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
     {
-        s1 += pow(x[i], 2);
-        s2 += 0.5 * (i + 1) * x[i];
+        __m256d s = _mm256_setzero_pd();
+        for (size_t d = 0; d + 1 < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            __m256d a = _mm256_sub_pd(one, v);
+            __m256d b = _mm256_sub_pd(_mm256_loadu_pd(x + (d + 1) * count + k), _mm256_mul_pd(v, v));
+            s = _mm256_add_pd(s, _mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(hundred, _mm256_mul_pd(b, b))));
+        }
+        _mm256_storeu_pd(fitness + k, s);
     }
-    return s1 + pow(s2, 2) + pow(s2, 4);
+    rosenbrockScalar(x, dimensions, count, k, fitness);
 }
 
-double rosenbrock(std::vector<double> x)
+__attribute__((target("avx2"))) void ackleyAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double res = 0;
-    for (size_t i = 0; i < x.size() - 1; i++)
+    alignas(32) double s1[4], s2[4];
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
     {
-        res += pow(1 - x[i], 2) + 100 * pow(x[i + 1] - pow(x[i], 2), 2);
+        __m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            a = _mm256_add_pd(a, _mm256_mul_pd(v, v));
+            b = _mm256_add_pd(b, cosineAVX2(_mm256_mul_pd(_mm256_set1_pd(twoPi), v)));
+        }
+        _mm256_store_pd(s1, a);
+        _mm256_store_pd(s2, b);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            fitness[k + lane] = ackleyValue(s1[lane], s2[lane], dimensions);
+        }
     }
-    return res;
+    ackleyScalar(x, dimensions, count, k, fitness);
 }
 
-double ackley(std::vector<double> x)
+__attribute__((target("avx2"))) void griewangkAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double s1 = 0;
-    double s2 = 0;
-    for (size_t i = 0; i < x.size(); i++)
+    const double *divisors = getGriewangkDivisors(dimensions);
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
     {
-        s1 += pow(x[i], 2);
-        s2 += cos(2 * M_PI * x[i]);
+        __m256d s1 = _mm256_setzero_pd(), m1 = _mm256_set1_pd(1);
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            s1 = _mm256_add_pd(s1, _mm256_div_pd(_mm256_mul_pd(v, v), _mm256_set1_pd(4000.)));
+            m1 = _mm256_mul_pd(m1, cosineAVX2(_mm256_div_pd(v, _mm256_set1_pd(divisors[d]))));
+        }
+        _mm256_storeu_pd(fitness + k, _mm256_add_pd(_mm256_sub_pd(s1, m1), _mm256_set1_pd(1)));
     }
-    return -20 * exp(-0.2 * sqrt(s1 / x.size())) - exp(s2 / x.size()) + 20 + exp(1);
+    griewangkScalar(x, dimensions, count, k, fitness);
 }
 
-double griewangk(std::vector<double> x)
+__attribute__((target("avx2"))) void rastriginAVX2(const double *x, size_t dimensions, size_t count, size_t first, double *fitness)
 {
-    double s1 = 0;
-    double m1 = 1;
-    for (size_t i = 0; i < x.size(); i++)
+    const __m256d ten = _mm256_set1_pd(10);
+    size_t k = first;
+    for (; k + 4 <= count; k += 4)
     {
-        s1 += pow(x[i], 2) / 4000.;
-        m1 *= cos(x[i] / sqrt(i + 1));
+        __m256d s1 = _mm256_setzero_pd();
+        for (size_t d = 0; d < dimensions; d++)
+        {
+            __m256d v = _mm256_loadu_pd(x + d * count + k);
+            __m256d c = cosineAVX2(_mm256_mul_pd(_mm256_set1_pd(twoPi), v));
+            s1 = _mm256_add_pd(s1, _mm256_sub_pd(_mm256_mul_pd(v, v), _mm256_mul_pd(ten, c)));
+        }
+        _mm256_storeu_pd(fitness + k, _mm256_add_pd(_mm256_set1_pd(10. * dimensions), s1));
     }
-    return s1 - m1 + 1;
+    rastriginScalar(x, dimensions, count, k, fitness);
 }
+#endif
 
-double rastrigin(std::vector<double> x)
+Dispatch selectDispatch()
 {
-    double s1 = 0;
-    for (size_t i = 0; i < x.size(); i++)
+#ifdef TEST_FUNCTIONS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
     {
-        s1 += pow(x[i], 2) - 10 * cos(2 * M_PI * x[i]);
+        return {sphereAVX2, ellipsoidAVX2, zakharovAVX2, rosenbrockAVX2, ackleyAVX2, griewangkAVX2, rastriginAVX2, "avx2"};
     }
-    return 10 * x.size() + s1;
+#endif
+    return {sphereScalar, ellipsoidScalar, zakharovScalar, rosenbrockScalar, ackleyScalar, griewangkScalar, rastriginScalar, "scalar"};
+}
+
+const Dispatch &getDispatch()
+{
+    static const Dispatch dispatch = selectDispatch();
+    return dispatch;
+}
+}
+
+// A single point is a population of one, laid out the same way.
+double sphere(const std::vector<double> &x)
+{
+    double fitness;
+    sphereScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void sphere(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().sphere(x, dimensions, count, 0, fitness);
+}
+
+double ellipsoid(const std::vector<double> &x)
+{
+    double fitness;
+    ellipsoidScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void ellipsoid(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().ellipsoid(x, dimensions, count, 0, fitness);
+}
+
+double zakharov(const std::vector<double> &x)
+{
+    double fitness;
+    zakharovScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void zakharov(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().zakharov(x, dimensions, count, 0, fitness);
+}
+
+double rosenbrock(const std::vector<double> &x)
+{
+    double fitness;
+    rosenbrockScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void rosenbrock(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().rosenbrock(x, dimensions, count, 0, fitness);
+}
+
+double ackley(const std::vector<double> &x)
+{
+    double fitness;
+    ackleyScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void ackley(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().ackley(x, dimensions, count, 0, fitness);
+}
+
+double griewangk(const std::vector<double> &x)
+{
+    double fitness;
+    griewangkScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void griewangk(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().griewangk(x, dimensions, count, 0, fitness);
+}
+
+double rastrigin(const std::vector<double> &x)
+{
+    double fitness;
+    rastriginScalar(x.data(), x.size(), 1, 0, &fitness);
+    return fitness;
+}
+
+void rastrigin(const double *x, size_t dimensions, size_t count, double *fitness)
+{
+    getDispatch().rastrigin(x, dimensions, count, 0, fitness);
+}
+
+const char *getInstructionSet()
+{
+    return getDispatch().instructionSet;
 }
 }
@@ -5,21 +5,35 @@
 #include <vector>
 #include <cstddef>
 
+// Every function can score one point or a whole population at once. A
+// population is stored by variable: x[d * count + k] is variable d of point
+// k, and the value of point k is written to fitness[k]. The batch versions
+// run on AVX2 when the CPU has it, and give the same values as the single
+// ones on every machine.
 namespace tf
 {
-double sphere(std::vector<double> x);
+double sphere(const std::vector<double> &x);
+void sphere(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double ellipsoid(std::vector<double> x);
+double ellipsoid(const std::vector<double> &x);
+void ellipsoid(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double zakharov(std::vector<double> x);
+double zakharov(const std::vector<double> &x);
+void zakharov(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double rosenbrock(std::vector<double> x);
+double rosenbrock(const std::vector<double> &x);
+void rosenbrock(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double ackley(std::vector<double> x);
+double ackley(const std::vector<double> &x);
+void ackley(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double griewangk(std::vector<double> x);
+double griewangk(const std::vector<double> &x);
+void griewangk(const double *x, size_t dimensions, size_t count, double *fitness);
 
-double rastrigin(std::vector<double> x);
+double rastrigin(const std::vector<double> &x);
+void rastrigin(const double *x, size_t dimensions, size_t count, double *fitness);
+
+const char *getInstructionSet();
 }
 
-#endif // TEST_FUNCTIONS_HPP
\ No newline at end of file
+#endif // TEST_FUNCTIONS_HPP
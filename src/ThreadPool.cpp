@@ -0,0 +1,84 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(size_t threads)
+    : task(nullptr), context(nullptr), next(0), last(0), running(0), loop(0), stop(false)
+{
+    for (size_t i = 1; i < threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    startLoop.notify_all();
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+size_t ThreadPool::getThreads() const
+{
+    return workers.size() + 1;
+}
+
+void ThreadPool::runTasks()
+{
+    for (size_t i = next++; i < last; i = next++)
+    {
+        task(context, i);
+    }
+}
+
+void ThreadPool::work()
+{
+    size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startLoop.wait(lock, [&] { return stop || loop != seen; });
+            if (stop)
+            {
+                return;
+            }
+            seen = loop;
+        }
+        runTasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+        }
+        endLoop.notify_one();
+    }
+}
+
+void ThreadPool::execute(void (*task)(void *, size_t), void *context, size_t begin, size_t end)
+{
+    if (workers.empty() || end - begin < 2)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            task(context, i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = task;
+        this->context = context;
+        next = begin;
+        last = end;
+        running = workers.size();
+        loop++;
+    }
+    startLoop.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(mutex);
+    endLoop.wait(lock, [&] { return running == 0; });
+}
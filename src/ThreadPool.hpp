@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+// Fixed set of worker threads that execute parallel loops. The calling thread
+// takes part in every loop, so a pool of n threads starts n - 1 workers.
+// Indices are handed out dynamically, which keeps cores busy when the cost per
+// index varies.
+class ThreadPool
+{
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable startLoop;
+  std::condition_variable endLoop;
+
+  void (*task)(void *context, size_t i);
+  void *context;
+  std::atomic<size_t> next;
+  size_t last;
+  size_t running;
+  size_t loop;
+  bool stop;
+
+  void work();
+  void runTasks();
+  void execute(void (*task)(void *, size_t), void *context, size_t begin, size_t end);
+
+  template<class F>
+  static void call(void *f, size_t i)
+  {
+    (*static_cast<F *>(f))(i);
+  }
+
+public:
+  ThreadPool(size_t threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t getThreads() const;
+
+  template<class F>
+  void parallelFor(size_t begin, size_t end, F f)
+  {
+    execute(&ThreadPool::call<F>, &f, begin, end);
+  }
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,70 @@
+#include "WorkStealingPool.hpp"
+
+WorkStealingPool::WorkStealingPool(size_t threads) : threads(threads > 0 ? threads : 1)
+{
+    for (size_t i = 0; i < this->threads; i++)
+    {
+        queues.emplace_back(new Queue());
+    }
+}
+
+size_t WorkStealingPool::getThreads() const
+{
+    return threads;
+}
+
+bool WorkStealingPool::pop(size_t worker, size_t &task)
+{
+    Queue &queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t worker, size_t &task)
+{
+    for (size_t i = 1; i < threads; i++)
+    {
+        Queue &queue = *queues[(worker + i) % threads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t worker, const std::function<void(size_t, size_t)> &f)
+{
+    size_t task;
+    while (pop(worker, task) || steal(worker, task))
+    {
+        f(task, worker);
+    }
+}
+
+void WorkStealingPool::run(size_t tasks, const std::function<void(size_t task, size_t worker)> &f)
+{
+    for (size_t task = 0; task < tasks; task++)
+    {
+        queues[task % threads]->tasks.push_front(task);
+    }
+    std::vector<std::thread> workers;
+    for (size_t worker = 1; worker < threads; worker++)
+    {
+        workers.emplace_back(&WorkStealingPool::work, this, worker, std::cref(f));
+    }
+    work(0, f);
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+// Runs a batch of independent tasks. Each worker owns a queue and takes tasks
+// from its back; when it runs dry it steals from the front of the others, so
+// a few long tasks do not leave the rest of the workers idle.
+class WorkStealingPool
+{
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  size_t threads;
+  std::vector<std::unique_ptr<Queue>> queues;
+
+  bool pop(size_t worker, size_t &task);
+  bool steal(size_t worker, size_t &task);
+  void work(size_t worker, const std::function<void(size_t, size_t)> &f);
+
+public:
+  WorkStealingPool(size_t threads);
+
+  size_t getThreads() const;
+
+  // Calls f(task, worker) for every task in [0, tasks) and waits for all.
+  void run(size_t tasks, const std::function<void(size_t task, size_t worker)> &f);
+};
+
+#endif // WORK_STEALING_POOL_HPP
@@ -1,19 +1,23 @@
 #include <iostream>
-#include <ctime>
 #include <chrono>
 #include <bitset>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 
 #include "Sudoku.hpp"
 #include "GeneticAlgorithm.hpp"
+#include "IslandModel.hpp"
+#include "BatchSolver.hpp"
 
 
 
 template<class T>
-void runTests(std::ostream &output, GeneticAlgorithm<T> &ga, int repetitions)
+void runTests(std::ostream &output, T &ga, size_t repetitions)
 {
     int durationInit = 0, durationSearch = 0;
     int average = 0, best = 10000, nSolve = 0;    
-    for (int i = 0; i < repetitions; i++)
+    for (size_t i = 0; i < repetitions; i++)
     {
         int c;
         auto start = std::chrono::steady_clock::now();
@@ -38,17 +42,212 @@ void runTests(std::ostream &output, GeneticAlgorithm<T> &ga, int repetitions)
     output << "Init population duration(ms): " << durationInit / (float)repetitions << " Optimization duration(ms): " << durationSearch / (float)repetitions << std::endl;
 }
 
-int main(int argc, char *argv[])
+// Reads a whole non-negative integer. Signs, spaces, trailing characters and
+// values that do not fit are rejected.
+bool readNumber(const char *text, uint64_t &value)
+{
+    if (!std::isdigit((unsigned char)text[0]))
+    {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+// Reads a non-negative decimal number of seconds.
+bool readSeconds(const char *text, double &value)
+{
+    if (!std::isdigit((unsigned char)text[0]) && text[0] != '.')
+    {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    value = std::strtod(text, &end);
+    return *end == '\0' && errno == 0;
+}
+
+int runBatch(int argc, char *argv[])
+{
+    uint64_t threads = 1, seed = 1, evaluations = 0, stagnation = 0;
+    double seconds = 1800;
+    if (argc < 3 || argc > 8 || (argc > 3 && (!readNumber(argv[3], threads) || threads == 0)) ||
+        (argc > 4 && !readSeconds(argv[4], seconds)) || (argc > 5 && !readNumber(argv[5], seed)) ||
+        (argc > 6 && !readNumber(argv[6], evaluations)) || (argc > 7 && !readNumber(argv[7], stagnation)))
+    {
+        std::cout << "Uso: programa --batch directorio|archivo|- [hilos] [segundos] [semilla] [evaluaciones] [estancamiento]" << std::endl;
+        return -1;
+    }
+    Budget budget(seconds);
+    budget.evaluations = evaluations;
+    budget.stagnation = stagnation;
+    BatchSolver solver(threads, budget, seed);
+    if (!solver.load(argv[2]))
+    {
+        return -1;
+    }
+    solver.solve(std::cout);
+    return 0;
+}
+
+// Arguments of a run on one puzzle, already checked by readOptions.
+struct Options
 {
+    uint64_t tests;
+    uint64_t threads = 1;
+    bool hasSeed = false;
+    uint64_t seed = 0;
+    uint64_t islands = 0;
+    bool steadyState = false;
+    std::string trace = "-";
+    std::string checkpoint;
+};
+
+bool readOptions(int argc, char *argv[], Options &options)
+{
+    if (!readNumber(argv[2], options.tests) || options.tests == 0 ||
+        (argc > 3 && (!readNumber(argv[3], options.threads) || options.threads == 0)) ||
+        (argc > 4 && !readNumber(argv[4], options.seed)))
+    {
+        return false;
+    }
+    options.hasSeed = argc > 4;
+    if (argc > 5)
+    {
+        options.steadyState = std::string(argv[5]) == "asincrono";
+        if (!options.steadyState && std::string(argv[5]) != "-" && !readNumber(argv[5], options.islands))
+        {
+            return false;
+        }
+    }
+    if (argc > 6)
+    {
+        options.trace = argv[6];
+    }
+    if (argc > 7)
+    {
+        options.checkpoint = argv[7];
+    }
+    if (options.islands > 1 && (options.threads > 1 || options.trace != "-" || !options.checkpoint.empty()))
+    {
+        std::cout << "Las islas usan un hilo cada una y no admiten hilos, traza ni checkpoint" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<size_t B>
+int runSudoku(std::shared_ptr<const SudokuInstance> instance, const Options &options)
+{
+    BasicSudoku<B> sudoku(instance);
+    if (!sudoku.isValid())
+    {
+        return -1;
+    }
+    if (options.islands > 1)
+    {
+        IslandModel<BasicSudoku<B>> islands(sudoku, options.islands, 50, 1, 80, 0);
+        islands.setSeed(options.seed);
+        runTests(std::cout, islands, options.tests);
+        return 0;
+    }
+    GeneticAlgorithm<BasicSudoku<B>> ga(sudoku, 50, 1, 80, 0);
+    ga.setThreads(options.threads);
+    if (options.hasSeed)
+    {
+        ga.setSeed(options.seed);
+    }
+    ga.setSteadyState(options.steadyState);
+    std::unique_ptr<telemetry::TraceWriter> trace;
+    if (options.trace != "-")
+    {
+        const std::string &filename = options.trace;
+        trace.reset(new telemetry::TraceWriter(filename, filename.find(".json") != std::string::npos));
+        if (!trace->isOpen())
+        {
+            std::cout << "No se pudo abrir el archivo: " << filename << std::endl;
+            return -1;
+        }
+        ga.setObserver([&trace](const telemetry::GenerationStats &stats) { (*trace)(stats); });
+    }
+    if (!options.checkpoint.empty())
+    {
+        ga.setCheckpoint(options.checkpoint, 10);
+    }
+    runTests(std::cout, ga, options.tests);
+    return 0;
+}
 
-    if (argc != 3)
+template<size_t B>
+int resumeSudoku(std::shared_ptr<const SudokuInstance> instance, const std::string &filename, size_t threads, double maxSeconds)
+{
+    BasicSudoku<B> sudoku(instance);
+    if (!sudoku.isValid())
     {
-        std::cout << "Uso: programa sudoku pruebas" << std::endl;
         return -1;
     }
-    std::srand(unsigned(std::time(0)));
-    Sudoku sudoku(argv[1]);
-    GeneticAlgorithm<Sudoku> ga(sudoku, 50, 1, 80, 0);    
-    runTests(std::cout, ga, atoi(argv[2]));
+    GeneticAlgorithm<BasicSudoku<B>> ga(sudoku, 50, 1, 80, 0);
+    ga.setThreads(threads);
+    if (!ga.loadCheckpoint(filename))
+    {
+        return -1;
+    }
+    ga.setCheckpoint(filename, 10);
+    std::cout << "Generations: " << ga.run(maxSeconds) << " ";
+    std::cout << "Final fitness: " << ga.getBest().getFitness() << std::endl;
     return 0;
+}
+
+int runResume(int argc, char *argv[])
+{
+    uint64_t threads = 1;
+    double maxSeconds = 1800;
+    if (argc < 4 || argc > 6 || (argc > 4 && (!readNumber(argv[4], threads) || threads == 0)) ||
+        (argc > 5 && !readSeconds(argv[5], maxSeconds)))
+    {
+        std::cout << "Uso: programa --resume checkpoint sudoku [hilos] [segundos]" << std::endl;
+        return -1;
+    }
+    auto instance = std::make_shared<const SudokuInstance>(argv[3]);
+    if (!instance->isValid())
+    {
+        return -1;
+    }
+    int result = -1;
+    if (!dispatchBlockSize(*instance, [&](auto size) { result = resumeSudoku<decltype(size)::value>(instance, argv[2], threads, maxSeconds); }))
+    {
+        std::cout << "Tamano de sudoku no soportado: " << instance->getSize() << std::endl;
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+    {
+        return runBatch(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--resume")
+    {
+        return runResume(argc, argv);
+    }
+    Options options;
+    if (argc < 3 || argc > 8 || !readOptions(argc, argv, options))
+    {
+        std::cout << "Uso: programa sudoku pruebas [hilos] [semilla] [islas|asincrono|-] [traza.csv|traza.jsonl|-] [checkpoint]" << std::endl;
+        return -1;
+    }
+    auto instance = std::make_shared<const SudokuInstance>(argv[1]);
+    if (!instance->isValid())
+    {
+        return -1;
+    }
+    int result = -1;
+    if (!dispatchBlockSize(*instance, [&](auto size) { result = runSudoku<decltype(size)::value>(instance, options); }))
+    {
+        std::cout << "Tamano de sudoku no soportado: " << instance->getSize() << std::endl;
+    }
+    return result;
 }
\ No newline at end of file